@@ -276,31 +276,55 @@ void CutterCore::analyze(int level,  QList<QString> advanced)
 
 void CutterCore::renameFunction(const QString &oldName, const QString &newName)
 {
+    CORE_LOCK();
+    // afn also renames the flag of the function, if it has one
+    bool flagged = r_flag_get(core_->flags, oldName.toUtf8().constData()) != nullptr;
     cmdRaw("afn " + newName + " " + oldName);
     emit functionRenamed(oldName, newName);
+    if (flagged && !r_flag_get(core_->flags, oldName.toUtf8().constData())) {
+        emit flagRenamed(oldName, newName);
+        emit flagsChanged();
+    }
 }
 
 void CutterCore::delFunction(RVA addr)
 {
     cmd("af- " + RAddressString(addr));
     emit functionsChanged();
+    emit functionsChangedInRange(addr, addr);
 }
 
 void CutterCore::renameFlag(QString old_name, QString new_name)
 {
     cmdRaw("fr " + old_name + " " + new_name);
+    emit flagRenamed(old_name, new_name);
     emit flagsChanged();
 }
 
 void CutterCore::delFlag(RVA addr)
 {
+    CORE_LOCK();
+    QStringList names;
+    const RList *flags = r_flag_get_list(core_->flags, addr);
+    RListIter *it;
+    RFlagItem *flag;
+    CutterRListForeach(flags, it, RFlagItem, flag) {
+        names << QString(flag->name);
+    }
+
     cmd("f-@" + RAddressString(addr));
+    for (const QString &name : names) {
+        if (!r_flag_get(core_->flags, name.toUtf8().constData())) {
+            emit flagRemoved(name);
+        }
+    }
     emit flagsChanged();
 }
 
 void CutterCore::delFlag(const QString &name)
 {
     cmdRaw("f-" + name);
+    emit flagRemoved(name);
     emit flagsChanged();
 }
 
@@ -646,6 +670,7 @@ QString CutterCore::createFunctionAt(RVA addr, QString name)
     QString command = "af " + name + " " + RAddressString(addr);
     QString ret = cmd(command);
     emit functionsChanged();
+    emit functionsChangedInRange(addr, addr);
     return ret;
 }
 
@@ -971,6 +996,27 @@ QList<FunctionDescription> CutterCore::getAllFunctions()
     return ret;
 }
 
+QList<FunctionDescription> CutterCore::getFunctionsInRange(RVA from, RVA to)
+{
+    CORE_LOCK();
+    QList<FunctionDescription> ret;
+
+    RListIter *it;
+    RAnalFunction *fcn;
+    CutterRListForeach(core_->anal->fcns, it, RAnalFunction, fcn) {
+        if (fcn->addr < from || fcn->addr > to) {
+            continue;
+        }
+        FunctionDescription function;
+        function.offset = fcn->addr;
+        function.size = r_anal_fcn_size(fcn);
+        function.name = QString(fcn->name);
+        ret << function;
+    }
+
+    return ret;
+}
+
 QList<ImportDescription> CutterCore::getAllImports()
 {
     CORE_LOCK();
@@ -1120,6 +1166,7 @@ QList<StringDescription> CutterCore::getAllStrings()
         string.type = stringObject["type"].toString();
         string.size = stringObject["size"].toVariant().toUInt();
         string.length = stringObject["length"].toVariant().toUInt();
+        string.section = stringObject["section"].toString();
 
         ret << string;
     }
@@ -1466,10 +1513,34 @@ QList<XrefDescription> CutterCore::getXRefs(RVA addr, bool to, bool whole_functi
     return ret;
 }
 
+QVector<QPair<RVA, RVA>> CutterCore::getAllCallReferences()
+{
+    CORE_LOCK();
+    QVector<QPair<RVA, RVA>> ret;
+
+    RList *refs = r_anal_xrefs_list(core_->anal);
+    RListIter *it;
+    RAnalRef *ref;
+    CutterRListForeach(refs, it, RAnalRef, ref) {
+        if (ref->type == R_ANAL_REF_TYPE_CALL) {
+            ret << qMakePair(RVA(ref->at), RVA(ref->addr));
+        }
+    }
+    r_list_free(refs);
+
+    return ret;
+}
+
 void CutterCore::addFlag(RVA offset, QString name, RVA size)
 {
+    CORE_LOCK();
     name = sanitizeStringForCommand(name);
+    // Setting an existing flag only moves it
+    bool existed = r_flag_get(core_->flags, name.toUtf8().constData()) != nullptr;
     cmd(QString("f %1 %2 @ %3").arg(name).arg(size).arg(offset));
+    if (!existed) {
+        emit flagAdded(name);
+    }
     emit flagsChanged();
 }
 
@@ -1485,7 +1556,13 @@ void CutterCore::triggerVarsChanged()
 
 void CutterCore::triggerFunctionRenamed(const QString &prevName, const QString &newName)
 {
+    CORE_LOCK();
     emit functionRenamed(prevName, newName);
+    // The rename already happened, a flag under the new name only can only be the renamed one
+    if (r_flag_get(core_->flags, newName.toUtf8().constData())
+            && !r_flag_get(core_->flags, prevName.toUtf8().constData())) {
+        emit flagRenamed(prevName, newName);
+    }
 }
 
 void CutterCore::loadPDB(const QString &file)
@@ -129,6 +129,7 @@ struct StringDescription {
     QString type;
     ut32 length;
     ut32 size;
+    QString section;
 };
 
 struct FlagspaceDescription {
@@ -406,6 +407,8 @@ public:
     QList<RAsmPluginDescription> getRAsmPluginDescriptions();
 
     QList<FunctionDescription> getAllFunctions();
+    // Functions starting at an address in [from, to]
+    QList<FunctionDescription> getFunctionsInRange(RVA from, RVA to);
     QList<ImportDescription> getAllImports();
     QList<ExportDescription> getAllExports();
     QList<SymbolDescription> getAllSymbols();
@@ -425,6 +428,8 @@ public:
 
     QList<XrefDescription> getXRefs(RVA addr, bool to, bool whole_function,
                                     const QString &filterType = QString::null);
+    // All call references as (address of the call, called address)
+    QVector<QPair<RVA, RVA>> getAllCallReferences();
 
     void addFlag(RVA offset, QString name, RVA size);
     void triggerFlagsChanged();
@@ -454,7 +459,16 @@ signals:
     void functionRenamed(const QString &prev_name, const QString &new_name);
     void varsChanged();
     void functionsChanged();
+    /*!
+     * \brief Emitted after functionsChanged() when only functions starting in [from, to]
+     * were added, removed or changed
+     */
+    void functionsChangedInRange(RVA from, RVA to);
     void flagsChanged();
+    // Emitted before flagsChanged() when a single flag was added, renamed or removed
+    void flagAdded(const QString &name);
+    void flagRenamed(const QString &oldName, const QString &newName);
+    void flagRemoved(const QString &name);
     void commentsChanged();
     void instructionChanged(RVA offset);
 
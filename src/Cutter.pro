@@ -130,6 +130,18 @@ SOURCES += \
     widgets/PseudocodeWidget.cpp \
     widgets/VisualNavbar.cpp \
     widgets/GraphView.cpp \
+    widgets/GraphLayout.cpp \
+    widgets/GraphSpatialIndex.cpp \
+    widgets/CallGraphView.cpp \
+    widgets/CallGraphWidget.cpp \
+    utils/AddressRangeIndex.cpp \
+    utils/CallGraph.cpp \
+    utils/ColumnarTable.cpp \
+    utils/FilterEngine.cpp \
+    utils/StringScanner.cpp \
+    utils/FunctionMetrics.cpp \
+    utils/NameIndex.cpp \
+    utils/GraphExporter.cpp \
     dialogs/preferences/PreferencesDialog.cpp \
     dialogs/preferences/GeneralOptionsWidget.cpp \
     dialogs/preferences/GraphOptionsWidget.cpp \
@@ -201,6 +213,18 @@ HEADERS  += \
     widgets/PseudocodeWidget.h \
     widgets/VisualNavbar.h \
     widgets/GraphView.h \
+    widgets/GraphLayout.h \
+    widgets/GraphSpatialIndex.h \
+    widgets/CallGraphView.h \
+    widgets/CallGraphWidget.h \
+    utils/AddressRangeIndex.h \
+    utils/CallGraph.h \
+    utils/ColumnarTable.h \
+    utils/FilterEngine.h \
+    utils/StringScanner.h \
+    utils/FunctionMetrics.h \
+    utils/NameIndex.h \
+    utils/GraphExporter.h \
     dialogs/preferences/PreferencesDialog.h \
     dialogs/preferences/GeneralOptionsWidget.h \
     dialogs/preferences/GraphOptionsWidget.h \
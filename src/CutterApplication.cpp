@@ -8,6 +8,12 @@
 #include <QTextCodec>
 #include <QStringList>
 #include <QProcess>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QMap>
+
+#include "utils/GraphExporter.h"
+#include "utils/StringScanner.h"
 
 #ifdef CUTTER_ENABLE_JUPYTER
 #include "utils/JupyterConnection.h"
@@ -38,6 +44,20 @@ CutterApplication::CutterApplication(int &argc, char **argv) : QApplication(argc
                                   QObject::tr("level"));
     cmd_parser.addOption(analOption);
 
+    QCommandLineOption exportGraphsOption("export-graphs",
+                                          QObject::tr("Open and analyze the file without showing a window, write the graphs of all functions into directory and quit. The analysis level defaults to 1."),
+                                          QObject::tr("directory"));
+    cmd_parser.addOption(exportGraphsOption);
+
+    QCommandLineOption exportFormatOption("export-format",
+                                          QObject::tr("Format of the graphs written by --export-graphs: svg (default), png, dot or json."),
+                                          QObject::tr("format"));
+    cmd_parser.addOption(exportFormatOption);
+
+    QCommandLineOption compareStringsOption("compare-strings",
+                                            QObject::tr("Open the file without showing a window, find its strings with izzj and with Cutter's own scanner, print how long each took and how their results differ and quit."));
+    cmd_parser.addOption(compareStringsOption);
+
 #ifdef CUTTER_ENABLE_JUPYTER
     QCommandLineOption pythonHomeOption("pythonhome", QObject::tr("PYTHONHOME to use for Jupyter"),
                                         "PYTHONHOME");
@@ -47,11 +67,16 @@ CutterApplication::CutterApplication(int &argc, char **argv) : QApplication(argc
     cmd_parser.process(*this);
 
     QStringList args = cmd_parser.positionalArguments();
+    bool headless = cmd_parser.isSet(exportGraphsOption) || cmd_parser.isSet(compareStringsOption);
 
     // Check r2 version
     QString r2version = r_core_version();
     QString localVersion = "" R2_GITTAP;
-    if (r2version != localVersion) {
+    if (r2version != localVersion && headless) {
+        fprintf(stderr, "%s\n",
+                QObject::tr("Warning: the version used to compile Cutter (%1) does not match the binary version of radare2 (%2).").arg(
+                    localVersion, r2version).toLocal8Bit().constData());
+    } else if (r2version != localVersion) {
         QMessageBox msg;
         msg.setIcon(QMessageBox::Critical);
         msg.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
@@ -82,6 +107,34 @@ CutterApplication::CutterApplication(int &argc, char **argv) : QApplication(argc
         }
     }
 
+    if (cmd_parser.isSet(compareStringsOption)) {
+        if (args.empty()) {
+            printf("%s\n",
+                   QObject::tr("Filename must be specified to compare strings.").toLocal8Bit().constData());
+            exit(1);
+        }
+        compareStrings(args[0]);
+        return;
+    }
+
+    if (headless) {
+        if (args.empty()) {
+            printf("%s\n",
+                   QObject::tr("Filename must be specified to export graphs.").toLocal8Bit().constData());
+            exit(1);
+        }
+        GraphExporter::Format format = GraphExporter::Format::Svg;
+        if (cmd_parser.isSet(exportFormatOption)
+                && !GraphExporter::formatFromName(cmd_parser.value(exportFormatOption), &format)) {
+            printf("%s\n",
+                   QObject::tr("Invalid export format. May be svg, png, dot or json.").toLocal8Bit().constData());
+            exit(1);
+        }
+        exportGraphs(args[0], analLevelSpecified ? analLevel : 1,
+                     cmd_parser.value(exportGraphsOption), format);
+        return;
+    }
+
     mainWindow = new MainWindow();
 
     if (args.empty()) {
@@ -102,9 +155,95 @@ CutterApplication::~CutterApplication()
     delete mainWindow;
 }
 
+// Runs without a main window, the application quits once all graphs are written
+void CutterApplication::exportGraphs(const QString &fileName, int analLevel,
+                                     const QString &directory, GraphExporter::Format format)
+{
+    if (!QDir().mkpath(directory)) {
+        printf("%s\n",
+               QObject::tr("Could not create directory %1.").arg(directory).toLocal8Bit().constData());
+        exit(1);
+    }
+    if (!Core()->loadFile(fileName, 0, 0, R_IO_READ | R_IO_EXEC, 2, 0, true)) {
+        printf("%s\n",
+               QObject::tr("Could not open %1.").arg(fileName).toLocal8Bit().constData());
+        exit(1);
+    }
+    Core()->analyze(analLevel, QList<QString>());
+
+    GraphExporter *exporter = new GraphExporter(this);
+    connect(exporter, &GraphExporter::progress, this, [](int done, int total) {
+        fprintf(stderr, "\r%d/%d", done, total);
+    });
+    connect(exporter, &GraphExporter::finished, this, [](int exported, int failed) {
+        printf("\n%s\n", QObject::tr("Exported %1 graphs, %2 failed.").arg(exported).arg(
+                   failed).toLocal8Bit().constData());
+        QCoreApplication::exit(failed ? 1 : 0);
+    });
+    exporter->start(Core()->getAllFunctions(), directory, format);
+}
+
+// Runs without a main window, the application quits once the scanner is done
+void CutterApplication::compareStrings(const QString &fileName)
+{
+    if (!Core()->loadFile(fileName, 0, 0, R_IO_READ, 2, 0, true)) {
+        printf("%s\n",
+               QObject::tr("Could not open %1.").arg(fileName).toLocal8Bit().constData());
+        exit(1);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QList<StringDescription> izzStrings = Core()->getAllStrings();
+    qint64 izzTime = timer.elapsed();
+
+    // Compared by address, the scanner may find strings at addresses izz does not know
+    QMap<RVA, QString> reference;
+    for (const StringDescription &string : izzStrings) {
+        reference.insert(string.vaddr, string.string);
+    }
+
+    StringScanner *scanner = new StringScanner(this);
+    QList<StringDescription> *scanned = new QList<StringDescription>();
+    connect(scanner, &StringScanner::stringsFound, this,
+    [scanned](const QList<StringDescription> &strings) {
+        scanned->append(strings);
+    });
+    // Copies of a timer keep measuring from the same start
+    QElapsedTimer scanTimer;
+    scanTimer.start();
+    connect(scanner, &StringScanner::finished, this, [ = ]() {
+        qint64 scanTime = scanTimer.elapsed();
+        int same = 0;
+        int different = 0;
+        int onlyScanner = 0;
+        for (const StringDescription &string : *scanned) {
+            auto it = reference.find(string.vaddr);
+            if (it == reference.end()) {
+                onlyScanner++;
+            } else if (it.value() == string.string) {
+                same++;
+            } else {
+                different++;
+            }
+        }
+        int onlyIzz = reference.count() - same - different;
+
+        printf("%s\n", QObject::tr("izzj: %1 strings in %2 ms").arg(izzStrings.count()).arg(
+                   izzTime).toLocal8Bit().constData());
+        printf("%s\n", QObject::tr("scanner: %1 strings in %2 ms").arg(scanned->count()).arg(
+                   scanTime).toLocal8Bit().constData());
+        printf("%s\n", QObject::tr("%1 identical, %2 with different text, %3 only found by izzj, %4 only found by the scanner").arg(
+                   same).arg(different).arg(onlyIzz).arg(onlyScanner).toLocal8Bit().constData());
+        delete scanned;
+        QCoreApplication::exit(0);
+    });
+    scanner->start(StringScanner::defaultSections(), StringScanner::defaultMinLength());
+}
+
 bool CutterApplication::event(QEvent *e)
 {
-    if (e->type() == QEvent::FileOpen) {
+    if (e->type() == QEvent::FileOpen && mainWindow) {
         QFileOpenEvent *openEvent = static_cast<QFileOpenEvent *>(e);
         if (openEvent) {
             if (m_FileAlreadyDropped) {
@@ -5,6 +5,7 @@
 #include <QApplication>
 
 #include "MainWindow.h"
+#include "utils/GraphExporter.h"
 
 
 class CutterApplication : public QApplication
@@ -25,7 +26,11 @@ protected:
 
 private:
     bool m_FileAlreadyDropped;
-    MainWindow *mainWindow;
+    MainWindow *mainWindow = nullptr;
+
+    void exportGraphs(const QString &fileName, int analLevel, const QString &directory,
+                      GraphExporter::Format format);
+    void compareStrings(const QString &fileName);
 };
 
 #endif // CUTTERAPPLICATION_H
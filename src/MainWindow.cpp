@@ -17,11 +17,13 @@
 #include <QFileDialog>
 #include <QFont>
 #include <QFontDialog>
+#include <QInputDialog>
 #include <QLabel>
 #include <QLineEdit>
 #include <QList>
 #include <QMessageBox>
 #include <QProcess>
+#include <QProgressDialog>
 #include <QPropertyAnimation>
 #include <QScrollBar>
 #include <QSettings>
@@ -40,10 +42,12 @@
 #include "utils/HexAsciiHighlighter.h"
 #include "utils/Helpers.h"
 #include "utils/SvgIconEngine.h"
+#include "utils/GraphExporter.h"
 
 #include "dialogs/NewFileDialog.h"
 #include "widgets/DisassemblerGraphView.h"
 #include "widgets/GraphWidget.h"
+#include "widgets/CallGraphWidget.h"
 #include "widgets/FunctionsWidget.h"
 #include "widgets/SectionsWidget.h"
 #include "widgets/CommentsWidget.h"
@@ -159,6 +163,7 @@ void MainWindow::initUI()
 
     // Add graph view as dockable
     graphDock = new GraphWidget(this, ui->actionGraph);
+    callGraphDock = new CallGraphWidget(this, ui->actionCallGraph);
 
     // Hide centralWidget as we do not need it
     ui->centralWidget->hide();
@@ -323,11 +328,6 @@ bool MainWindow::saveProjectAs(bool quit)
     return !quit || result != SaveProjectDialog::Rejected;
 }
 
-void MainWindow::refreshOmniBar(const QStringList &flags)
-{
-    omnibar->refresh(flags);
-}
-
 void MainWindow::setFilename(const QString &fn)
 {
     // Add file name to window title
@@ -447,6 +447,7 @@ void MainWindow::restoreDocks()
     tabifyDockWidget(sectionsDock, commentsDock);
     tabifyDockWidget(dashboardDock, disassemblyDock);
     tabifyDockWidget(dashboardDock, graphDock);
+    tabifyDockWidget(dashboardDock, callGraphDock);
     tabifyDockWidget(dashboardDock, hexdumpDock);
     tabifyDockWidget(dashboardDock, pseudocodeDock);
     tabifyDockWidget(dashboardDock, entrypointDock);
@@ -723,6 +724,46 @@ void MainWindow::on_actionImportPDB_triggered()
     }
 }
 
+void MainWindow::on_actionExportGraphs_triggered()
+{
+    QString directory = QFileDialog::getExistingDirectory(this, tr("Export all graphs to"));
+    if (directory.isEmpty()) {
+        return;
+    }
+
+    bool ok;
+    QString formatName = QInputDialog::getItem(this, tr("Export All Graphs"), tr("Format:"),
+                                               { "SVG", "PNG", "DOT", "JSON" }, 0, false, &ok);
+    GraphExporter::Format format;
+    if (!ok || !GraphExporter::formatFromName(formatName, &format)) {
+        return;
+    }
+
+    GraphExporter *exporter = new GraphExporter(this);
+    QProgressDialog *progress = new QProgressDialog(tr("Exporting graphs..."), tr("Cancel"), 0, 0,
+                                                    this);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    // Closed when the exporter is done, not when the last graph starts
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    connect(progress, &QProgressDialog::canceled, exporter, &GraphExporter::cancel);
+    connect(exporter, &GraphExporter::progress, progress, [progress](int done, int total) {
+        progress->setMaximum(total);
+        progress->setValue(done);
+    });
+    connect(exporter, &GraphExporter::finished, this, [this, exporter, progress,
+          directory](int exported, int failed) {
+        progress->close();
+        addOutput(tr("Exported %1 graphs to %2").arg(exported).arg(directory));
+        if (failed) {
+            addOutput(tr("%1 graphs could not be exported").arg(failed));
+        }
+        exporter->deleteLater();
+    });
+    progress->show();
+    exporter->start(core->getAllFunctions(), directory, format);
+}
+
 void MainWindow::projectSaved(const QString &name)
 {
     addOutput(tr("Project saved: ") + name);
@@ -37,6 +37,7 @@ class ConsoleWidget;
 class EntrypointWidget;
 class DisassemblerGraphView;
 class ClassesWidget;
+class CallGraphWidget;
 class ResourcesWidget;
 class VTablesWidget;
 class TypesWidget;
@@ -89,7 +90,6 @@ public:
     void setFilename(const QString &fn);
     void addOutput(const QString &msg);
     void addDebugOutput(const QString &msg);
-    void refreshOmniBar(const QStringList &flags);
 
     void addToDockWidgetList(QDockWidget *dockWidget);
     void addDockWidgetAction(QDockWidget *dockWidget, QAction *action);
@@ -150,6 +150,8 @@ private slots:
 
     void on_actionImportPDB_triggered();
 
+    void on_actionExportGraphs_triggered();
+
     void projectSaved(const QString &name);
 
 private:
@@ -174,6 +176,7 @@ private:
     HexdumpWidget      *hexdumpDock = nullptr;
     PseudocodeWidget   *pseudocodeDock = nullptr;
     QDockWidget        *graphDock = nullptr;
+    CallGraphWidget    *callGraphDock = nullptr;
     EntrypointWidget   *entrypointDock = nullptr;
     FunctionsWidget    *functionsDock = nullptr;
     ImportsWidget      *importsDock = nullptr;
@@ -28,6 +28,12 @@ void GraphOptionsWidget::updateOptionsFromVars()
     ui->maxColsSpinBox->blockSignals(true);
     ui->maxColsSpinBox->setValue(Config()->getGraphBlockMaxChars());
     ui->maxColsSpinBox->blockSignals(false);
+    ui->layeredCheckBox->blockSignals(true);
+    ui->layeredCheckBox->setChecked(Config()->getGraphLayered());
+    ui->layeredCheckBox->blockSignals(false);
+    ui->minimapCheckBox->blockSignals(true);
+    ui->minimapCheckBox->setChecked(Config()->getGraphMinimap());
+    ui->minimapCheckBox->blockSignals(false);
 }
 
 
@@ -44,3 +50,14 @@ void GraphOptionsWidget::on_maxColsSpinBox_valueChanged(int value)
     triggerOptionsChanged();
 }
 
+void GraphOptionsWidget::on_layeredCheckBox_toggled(bool checked)
+{
+    Config()->setGraphLayered(checked);
+    triggerOptionsChanged();
+}
+
+void GraphOptionsWidget::on_minimapCheckBox_toggled(bool checked)
+{
+    Config()->setGraphMinimap(checked);
+    triggerOptionsChanged();
+}
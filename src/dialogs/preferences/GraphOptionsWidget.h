@@ -31,6 +31,8 @@ private slots:
     void updateOptionsFromVars();
 
     void on_maxColsSpinBox_valueChanged(int value);
+    void on_layeredCheckBox_toggled(bool checked);
+    void on_minimapCheckBox_toggled(bool checked);
 };
 
 
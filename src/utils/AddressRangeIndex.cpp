@@ -0,0 +1,75 @@
+#include "AddressRangeIndex.h"
+
+#include <algorithm>
+
+void AddressRangeIndex::add(RVA from, RVA to, int payload)
+{
+    if (to > from) {
+        ranges.push_back({ from, to, payload });
+    }
+}
+
+void AddressRangeIndex::clear()
+{
+    ranges.clear();
+    starts.clear();
+    payloads.clear();
+}
+
+// Sweeps over all range bounds, keeping the ranges containing the current bound
+// in a heap with the innermost one on top
+void AddressRangeIndex::build()
+{
+    starts.clear();
+    payloads.clear();
+
+    std::vector<RVA> bounds;
+    bounds.reserve(ranges.size() * 2);
+    for (const Range &range : ranges) {
+        bounds.push_back(range.from);
+        bounds.push_back(range.to);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    std::sort(ranges.begin(), ranges.end(), [](const Range & a, const Range & b) {
+        return a.from < b.from;
+    });
+
+    auto outerThan = [this](size_t a, size_t b) {
+        const Range &rangeA = ranges[a];
+        const Range &rangeB = ranges[b];
+        if (rangeA.from != rangeB.from) {
+            return rangeA.from < rangeB.from;
+        }
+        return rangeA.payload < rangeB.payload;
+    };
+    std::vector<size_t> open;
+    size_t next = 0;
+    for (RVA bound : bounds) {
+        while (next < ranges.size() && ranges[next].from <= bound) {
+            open.push_back(next++);
+            std::push_heap(open.begin(), open.end(), outerThan);
+        }
+        // Ranges which ended are only dropped once they get to the top
+        while (!open.empty() && ranges[open.front()].to <= bound) {
+            std::pop_heap(open.begin(), open.end(), outerThan);
+            open.pop_back();
+        }
+        int payload = open.empty() ? -1 : ranges[open.front()].payload;
+        if (payloads.empty() || payloads.back() != payload) {
+            starts.push_back(bound);
+            payloads.push_back(payload);
+        }
+    }
+
+    std::vector<Range>().swap(ranges);
+}
+
+int AddressRangeIndex::at(RVA addr) const
+{
+    auto it = std::upper_bound(starts.begin(), starts.end(), addr);
+    if (it == starts.begin()) {
+        return -1;
+    }
+    return payloads[it - starts.begin() - 1];
+}
@@ -0,0 +1,41 @@
+#ifndef ADDRESSRANGEINDEX_H
+#define ADDRESSRANGEINDEX_H
+
+#include <vector>
+
+#include "Cutter.h"
+
+/*!
+ * \brief Innermost of possibly nested or overlapping address ranges containing an address
+ *
+ * Collect the ranges with add(), then call build(). Where ranges overlap, the one
+ * starting last wins, and of ranges starting at the same address the one with the
+ * highest payload. build() splits the address space into pieces within which the
+ * winner stays the same, so at() is a binary search.
+ */
+class AddressRangeIndex
+{
+public:
+    // Adds [from, to), payload must not be negative. Empty ranges are ignored.
+    void add(RVA from, RVA to, int payload);
+    void build();
+    void clear();
+
+    // Payload of the innermost range containing addr, -1 if there is none
+    int at(RVA addr) const;
+
+private:
+    struct Range {
+        RVA from;
+        RVA to;
+        int payload;
+    };
+
+    // Added since the last build()
+    std::vector<Range> ranges;
+    // From starts[i] on, the innermost range has payloads[i], or -1 for none
+    std::vector<RVA> starts;
+    std::vector<int> payloads;
+};
+
+#endif // ADDRESSRANGEINDEX_H
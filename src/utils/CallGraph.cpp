@@ -0,0 +1,161 @@
+#include "CallGraph.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+void CallGraph::clear()
+{
+    functions.clear();
+    ranges.clear();
+    calleeStart.clear();
+    calleeIndex.clear();
+    callerStart.clear();
+    callerIndex.clear();
+}
+
+// Turns (from, to) pairs sorted by from into offsets and targets
+static void buildRows(const std::vector<std::pair<int, int>> &edges, int count,
+                      std::vector<int> &start, std::vector<int> &index)
+{
+    start.assign(count + 1, 0);
+    index.resize(edges.size());
+    for (const auto &edge : edges) {
+        start[edge.first + 1]++;
+    }
+    for (int i = 0; i < count; i++) {
+        start[i + 1] += start[i];
+    }
+    for (size_t i = 0; i < edges.size(); i++) {
+        index[i] = edges[i].second;
+    }
+}
+
+void CallGraph::build(const QList<FunctionDescription> &functions,
+                      const QVector<QPair<RVA, RVA>> &calls)
+{
+    clear();
+    this->functions.assign(functions.begin(), functions.end());
+    std::sort(this->functions.begin(), this->functions.end(),
+    [](const FunctionDescription & a, const FunctionDescription & b) {
+        return a.offset < b.offset;
+    });
+    for (int i = 0; i < count(); i++) {
+        // Functions without a size still own their entry
+        const FunctionDescription &function = this->functions[i];
+        ranges.add(function.offset, function.offset + std::max<RVA>(function.size, 1), i);
+    }
+    ranges.build();
+
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(calls.size());
+    for (const auto &call : calls) {
+        int caller = indexOf(call.first);
+        int callee = indexOf(call.second);
+        if (caller >= 0 && callee >= 0) {
+            edges.push_back(std::make_pair(caller, callee));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    buildRows(edges, count(), calleeStart, calleeIndex);
+
+    for (auto &edge : edges) {
+        std::swap(edge.first, edge.second);
+    }
+    std::sort(edges.begin(), edges.end());
+    buildRows(edges, count(), callerStart, callerIndex);
+}
+
+CallGraph::Range CallGraph::callees(int index) const
+{
+    const int *data = calleeIndex.data();
+    return { data + calleeStart[index], data + calleeStart[index + 1] };
+}
+
+CallGraph::Range CallGraph::callers(int index) const
+{
+    const int *data = callerIndex.data();
+    return { data + callerStart[index], data + callerStart[index + 1] };
+}
+
+std::vector<int> CallGraph::neighbourhood(int index, int hops, Direction direction,
+                                          int limit) const
+{
+    std::vector<int> result;
+    if (index < 0 || index >= count() || limit <= 0) {
+        return result;
+    }
+
+    // Breadth first, only the visited part of the graph is touched
+    std::unordered_map<int, int> distance;
+    distance[index] = 0;
+    result.push_back(index);
+    for (size_t next = 0; next < result.size(); next++) {
+        int current = result[next];
+        int currentDistance = distance[current];
+        if (currentDistance >= hops) {
+            continue;
+        }
+        auto visit = [&](Range range) {
+            for (int other : range) {
+                if (int(result.size()) >= limit) {
+                    return;
+                }
+                if (distance.emplace(other, currentDistance + 1).second) {
+                    result.push_back(other);
+                }
+            }
+        };
+        if (direction != Direction::Callers) {
+            visit(callees(current));
+        }
+        if (direction != Direction::Callees) {
+            visit(callers(current));
+        }
+        if (int(result.size()) >= limit) {
+            break;
+        }
+    }
+    return result;
+}
+
+std::vector<int> CallGraph::path(int from, int to) const
+{
+    std::vector<int> result;
+    if (from < 0 || to < 0 || from >= count() || to >= count()) {
+        return result;
+    }
+
+    std::unordered_map<int, int> parent;
+    parent[from] = -1;
+    std::vector<int> queue;
+    queue.push_back(from);
+    for (size_t next = 0; next < queue.size() && !parent.count(to); next++) {
+        int current = queue[next];
+        for (int callee : callees(current)) {
+            if (parent.emplace(callee, current).second) {
+                queue.push_back(callee);
+            }
+        }
+    }
+    if (!parent.count(to)) {
+        return result;
+    }
+
+    for (int current = to; current != -1; current = parent[current]) {
+        result.push_back(current);
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+CallGraphTask::CallGraphTask(const std::shared_ptr<CallGraph> &graph)
+    : graph(graph)
+{
+}
+
+void CallGraphTask::run()
+{
+    graph->build(Core()->getAllFunctions(), Core()->getAllCallReferences());
+    emit finished();
+}
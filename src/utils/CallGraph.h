@@ -0,0 +1,126 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QList>
+#include <QVector>
+#include <QPair>
+
+#include <memory>
+#include <vector>
+
+#include "Cutter.h"
+#include "utils/AddressRangeIndex.h"
+
+/*!
+ * \brief Calls between all functions of the binary
+ *
+ * Functions are addressed by their index in address order. Callees and callers
+ * are stored in compressed sparse row form, so even binaries with tens of
+ * thousands of functions only need a few flat arrays.
+ */
+class CallGraph
+{
+public:
+    enum class Direction {
+        Callees,
+        Callers,
+        Both,
+    };
+
+    // Callees or callers of one function
+    struct Range {
+        const int *first;
+        const int *last;
+
+        const int *begin() const
+        {
+            return first;
+        }
+        const int *end() const
+        {
+            return last;
+        }
+        int size() const
+        {
+            return int(last - first);
+        }
+    };
+
+    /*!
+     * \param functions all functions of the binary
+     * \param calls (address of the call instruction, called address) pairs
+     */
+    void build(const QList<FunctionDescription> &functions, const QVector<QPair<RVA, RVA>> &calls);
+    void clear();
+
+    bool isEmpty() const
+    {
+        return functions.empty();
+    }
+
+    int count() const
+    {
+        return int(functions.size());
+    }
+
+    const FunctionDescription &function(int index) const
+    {
+        return functions[index];
+    }
+
+    // Index of the innermost function containing addr, -1 if there is none
+    int indexOf(RVA addr) const
+    {
+        return ranges.at(addr);
+    }
+
+    Range callees(int index) const;
+    Range callers(int index) const;
+
+    /*!
+     * \brief Functions at most hops calls away from index, including index
+     * \return up to limit functions, closer ones first
+     */
+    std::vector<int> neighbourhood(int index, int hops, Direction direction, int limit) const;
+
+    // Shortest chain of calls leading from one function to another, including both.
+    // Empty if to can not be reached from from.
+    std::vector<int> path(int from, int to) const;
+
+    bool canReach(int from, int to) const
+    {
+        return !path(from, to).empty();
+    }
+
+private:
+    // Sorted by offset
+    std::vector<FunctionDescription> functions;
+    AddressRangeIndex ranges;
+    std::vector<int> calleeStart;
+    std::vector<int> calleeIndex;
+    std::vector<int> callerStart;
+    std::vector<int> callerIndex;
+};
+
+/*!
+ * \brief Builds a CallGraph from all functions and calls of the binary on a worker thread
+ */
+class CallGraphTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    explicit CallGraphTask(const std::shared_ptr<CallGraph> &graph);
+
+    void run() override;
+
+signals:
+    void finished();
+
+private:
+    std::shared_ptr<CallGraph> graph;
+};
+
+#endif // CALLGRAPH_H
@@ -0,0 +1,152 @@
+#include "ColumnarTable.h"
+
+#include <algorithm>
+
+ColumnarTable::ColumnarTable(int numberColumns, int stringColumns)
+    : numbers(numberColumns),
+      strings(stringColumns)
+{
+    clear();
+}
+
+void ColumnarTable::clear()
+{
+    rows = 0;
+    changes++;
+    for (auto &column : numbers) {
+        column.clear();
+    }
+    for (auto &column : strings) {
+        column.clear();
+    }
+    pool.clear();
+    foldedPool.clear();
+    poolIds.clear();
+    poolRanks.clear();
+    matchResults.clear();
+
+    // Id 0 is the empty string every row starts with
+    intern(QString());
+}
+
+void ColumnarTable::reserve(int rows)
+{
+    for (auto &column : numbers) {
+        column.reserve(rows);
+    }
+    for (auto &column : strings) {
+        column.reserve(rows);
+    }
+}
+
+int ColumnarTable::appendRow()
+{
+    for (auto &column : numbers) {
+        column.push_back(0);
+    }
+    for (auto &column : strings) {
+        column.push_back(0);
+    }
+    changes++;
+    return rows++;
+}
+
+void ColumnarTable::setString(int column, int row, const QString &value)
+{
+    strings[column][row] = intern(value);
+    changes++;
+}
+
+int ColumnarTable::intern(const QString &value)
+{
+    auto it = poolIds.constFind(value);
+    if (it != poolIds.constEnd()) {
+        return it.value();
+    }
+    int id = int(pool.size());
+    pool.push_back(value);
+    foldedPool.push_back(value.toCaseFolded());
+    poolIds.insert(value, id);
+    poolRanks.clear();
+    return id;
+}
+
+void ColumnarTable::updatePoolRanks() const
+{
+    // Pooled strings are unique, so sorting them once gives every string column its order
+    std::vector<int> order(pool.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = int(i);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return pool[a] < pool[b];
+    });
+    poolRanks.resize(pool.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        poolRanks[order[i]] = int(i);
+    }
+}
+
+bool ColumnarTable::stringLessThan(int column, int left, int right) const
+{
+    if (poolRanks.size() != pool.size()) {
+        updatePoolRanks();
+    }
+    return poolRanks[strings[column][left]] < poolRanks[strings[column][right]];
+}
+
+bool ColumnarTable::isPlainPattern(const QRegExp &regExp)
+{
+    QString pattern = regExp.pattern();
+    switch (regExp.patternSyntax()) {
+    case QRegExp::FixedString:
+        return true;
+    case QRegExp::Wildcard:
+        return !pattern.contains('*') && !pattern.contains('?') && !pattern.contains('[');
+    case QRegExp::WildcardUnix:
+        return !pattern.contains('*') && !pattern.contains('?') && !pattern.contains('[')
+               && !pattern.contains('\\');
+    default:
+        return false;
+    }
+}
+
+void ColumnarTable::resetMatches(const QRegExp &regExp) const
+{
+    matchRegExp = regExp;
+    matchResults.clear();
+
+    matchPlain = isPlainPattern(regExp);
+    QString pattern = regExp.pattern();
+    if (regExp.caseSensitivity() == Qt::CaseInsensitive) {
+        matchNeedle = pattern.toCaseFolded();
+    } else {
+        matchNeedle = pattern;
+    }
+}
+
+bool ColumnarTable::matches(int column, int row, const QRegExp &regExp) const
+{
+    if (regExp.isEmpty()) {
+        return true;
+    }
+    if (!(regExp == matchRegExp)) {
+        resetMatches(regExp);
+    }
+
+    int id = strings[column][row];
+    if (matchResults.size() < pool.size()) {
+        matchResults.resize(pool.size(), -1);
+    }
+    signed char &result = matchResults[id];
+    if (result < 0) {
+        if (!matchPlain) {
+            result = pool[id].contains(matchRegExp);
+        } else if (matchRegExp.caseSensitivity() == Qt::CaseInsensitive) {
+            result = foldedPool[id].contains(matchNeedle);
+        } else {
+            result = pool[id].contains(matchNeedle);
+        }
+    }
+    return result > 0;
+}
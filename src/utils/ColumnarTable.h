@@ -0,0 +1,116 @@
+#ifndef COLUMNARTABLE_H
+#define COLUMNARTABLE_H
+
+#include <QString>
+#include <QHash>
+#include <QRegExp>
+
+#include <vector>
+
+#include "Cutter.h"
+
+/*!
+ * \brief Rows of a list model stored column by column, for sorting and filtering
+ *
+ * Number columns are flat arrays. String columns hold ids into a pool shared
+ * by all string columns, so equal names are stored once together with their
+ * case folded form. Sort proxies compare rows through this instead of copying
+ * descriptions out of QVariants for every comparison.
+ */
+class ColumnarTable
+{
+public:
+    ColumnarTable(int numberColumns = 0, int stringColumns = 0);
+
+    void clear();
+    void reserve(int rows);
+
+    int rowCount() const
+    {
+        return rows;
+    }
+
+    // Changes whenever rows are added or strings are set
+    int generation() const
+    {
+        return changes;
+    }
+
+    // Appends a row with all numbers 0 and all strings empty, returns its index
+    int appendRow();
+
+    ut64 number(int column, int row) const
+    {
+        return numbers[column][row];
+    }
+    void setNumber(int column, int row, ut64 value)
+    {
+        numbers[column][row] = value;
+    }
+
+    const QString &string(int column, int row) const
+    {
+        return pool[strings[column][row]];
+    }
+    const QString &foldedString(int column, int row) const
+    {
+        return foldedPool[strings[column][row]];
+    }
+    void setString(int column, int row, const QString &value);
+
+    // Pool id of each row's string, for copying a column to another thread
+    const std::vector<int> &stringIds(int column) const
+    {
+        return strings[column];
+    }
+    const std::vector<QString> &stringPool() const
+    {
+        return pool;
+    }
+    const std::vector<QString> &foldedStringPool() const
+    {
+        return foldedPool;
+    }
+
+    bool numberLessThan(int column, int left, int right) const
+    {
+        return numbers[column][left] < numbers[column][right];
+    }
+    // Same order as comparing the strings, but only compares two precomputed ranks
+    bool stringLessThan(int column, int left, int right) const;
+
+    /*!
+     * \brief Whether the string contains a match of regExp, like QString::contains()
+     *
+     * Wildcard patterns without wildcards are plain substring searches on the case
+     * folded strings. Results are remembered per pooled string until regExp changes.
+     */
+    bool matches(int column, int row, const QRegExp &regExp) const;
+
+    // Whether regExp only matches itself, so QString::contains() with its pattern does the same
+    static bool isPlainPattern(const QRegExp &regExp);
+
+private:
+    int rows = 0;
+    int changes = 0;
+    std::vector<std::vector<ut64>> numbers;
+    std::vector<std::vector<int>> strings;
+
+    std::vector<QString> pool;
+    std::vector<QString> foldedPool;
+    QHash<QString, int> poolIds;
+    // Position of each pooled string in sorted order, empty when the pool changed
+    mutable std::vector<int> poolRanks;
+
+    mutable QRegExp matchRegExp;
+    mutable QString matchNeedle;
+    mutable bool matchPlain = false;
+    // Per pooled string: -1 not checked yet, 0 no match, 1 match
+    mutable std::vector<signed char> matchResults;
+
+    int intern(const QString &value);
+    void updatePoolRanks() const;
+    void resetMatches(const QRegExp &regExp) const;
+};
+
+#endif // COLUMNARTABLE_H
@@ -56,6 +56,22 @@ public:
     {
         s.setValue("graph.maxcols", ch);
     }
+    bool getGraphLayered() const
+    {
+        return s.value("graph.layered", false).toBool();
+    }
+    void setGraphLayered(bool v)
+    {
+        s.setValue("graph.layered", v);
+    }
+    bool getGraphMinimap() const
+    {
+        return s.value("graph.minimap", true).toBool();
+    }
+    void setGraphMinimap(bool v)
+    {
+        s.setValue("graph.minimap", v);
+    }
 
     // TODO Imho it's wrong doing it this way. Should find something else.
     bool getAsmESIL() const
@@ -0,0 +1,315 @@
+#include "FilterEngine.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+// Strings with consecutive pool ids, copied at once and never changed afterwards
+struct FilterEngine::Segment {
+    int first = 0;
+    std::vector<QString> strings;
+    std::vector<QString> folded;
+};
+
+// The copied string pool, owned by the runs using it. Appending only adds a segment,
+// so extending a source does not copy the strings before.
+struct FilterEngine::Source {
+    std::vector<std::shared_ptr<const Segment>> segments;
+    int count = 0;
+
+    void append(const ColumnarTable &table, int end)
+    {
+        auto segment = std::make_shared<Segment>();
+        segment->first = count;
+        segment->strings.assign(table.stringPool().begin() + count,
+                                table.stringPool().begin() + end);
+        segment->folded.assign(table.foldedStringPool().begin() + count,
+                               table.foldedStringPool().begin() + end);
+        segments.push_back(segment);
+        count = end;
+    }
+
+    const Segment &segmentOf(int id) const
+    {
+        auto it = std::upper_bound(segments.begin(), segments.end(), id,
+        [](int value, const std::shared_ptr<const Segment> &segment) {
+            return value < segment->first;
+        });
+        return **(it - 1);
+    }
+};
+
+// One query, shared by the thread starting it and all threads matching chunks
+struct FilterEngine::Run {
+    std::shared_ptr<const Source> source;
+    // Pool ids to check
+    QVector<int> candidates;
+    QRegExp regExp;
+    QString needle;
+    bool plain = false;
+    bool replace = false;
+    // Strings of the pool covered once this run is done
+    int count = 0;
+
+    // Per candidate, only written by the thread matching its chunk
+    std::vector<char> hits;
+    int chunkCount = 0;
+    QAtomicInt nextChunk;
+    QAtomicInt doneChunks;
+    QAtomicInt cancelled;
+    QMutex mutex;
+    QWaitCondition allDone;
+
+    // Matches chunks until there are none left
+    void work()
+    {
+        // QRegExp caches match state, so every thread needs its own
+        QRegExp localRegExp(regExp);
+        for (;;) {
+            int chunk = nextChunk.fetchAndAddRelaxed(1);
+            if (chunk >= chunkCount) {
+                return;
+            }
+            int first = chunk * CHUNK_SIZE;
+            int last = qMin(first + CHUNK_SIZE, candidates.size());
+            for (int i = first; i < last && !cancelled.load(); i++) {
+                int id = candidates.at(i);
+                const Segment &segment = source->segmentOf(id);
+                int index = id - segment.first;
+                if (!plain) {
+                    hits[i] = segment.strings[index].contains(localRegExp);
+                } else if (localRegExp.caseSensitivity() == Qt::CaseInsensitive) {
+                    hits[i] = segment.folded[index].contains(needle);
+                } else {
+                    hits[i] = segment.strings[index].contains(needle);
+                }
+            }
+            if (doneChunks.fetchAndAddOrdered(1) + 1 == chunkCount) {
+                QMutexLocker locker(&mutex);
+                allDone.wakeAll();
+            }
+        }
+    }
+};
+
+class FilterEngine::ChunkTask : public QRunnable
+{
+public:
+    explicit ChunkTask(const std::shared_ptr<Run> &filterRun) : filterRun(filterRun) {}
+
+    void run() override
+    {
+        filterRun->work();
+    }
+
+private:
+    std::shared_ptr<Run> filterRun;
+};
+
+// Spreads the chunks of a run over the global pool, helps with them and
+// reports the matching pool ids to the engine
+class FilterEngine::RunTask : public QRunnable
+{
+public:
+    RunTask(FilterEngine *engine, int generation, const std::shared_ptr<Run> &filterRun)
+        : engine(engine), generation(generation), filterRun(filterRun) {}
+
+    void run() override
+    {
+        QThreadPool *global = QThreadPool::globalInstance();
+        int helpers = qMin(global->maxThreadCount(), filterRun->chunkCount) - 1;
+        for (int i = 0; i < helpers; i++) {
+            global->start(new ChunkTask(filterRun));
+        }
+        filterRun->work();
+        {
+            QMutexLocker locker(&filterRun->mutex);
+            while (filterRun->doneChunks.load() < filterRun->chunkCount) {
+                filterRun->allDone.wait(&filterRun->mutex);
+            }
+        }
+        if (filterRun->cancelled.load()) {
+            return;
+        }
+
+        QVector<int> ids;
+        for (int i = 0; i < filterRun->candidates.size(); i++) {
+            if (filterRun->hits[i]) {
+                ids.append(filterRun->candidates.at(i));
+            }
+        }
+
+        QMetaObject::invokeMethod(engine, "runFinished", Qt::QueuedConnection,
+                                  Q_ARG(int, generation), Q_ARG(QVector<int>, ids));
+    }
+
+private:
+    FilterEngine *engine;
+    int generation;
+    std::shared_ptr<Run> filterRun;
+};
+
+FilterEngine::FilterEngine(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<QVector<int>>();
+    pool.setMaxThreadCount(1);
+}
+
+FilterEngine::~FilterEngine()
+{
+    cancelRuns();
+    pool.waitForDone();
+}
+
+void FilterEngine::setCaseSensitivity(Qt::CaseSensitivity caseSensitivity)
+{
+    if (this->caseSensitivity == caseSensitivity) {
+        return;
+    }
+    this->caseSensitivity = caseSensitivity;
+    lastValid = false;
+    start();
+}
+
+void FilterEngine::setSource(const ColumnarTable &table, int column)
+{
+    if (this->table == &table && this->column == column
+            && tableGeneration == table.generation()) {
+        return;
+    }
+    this->table = &table;
+    this->column = column;
+    tableGeneration = table.generation();
+    // Copied by the next query, not for every batch of rows added while there is none
+    source.reset();
+
+    // Old results are for other strings
+    matched.clear();
+    lastValid = false;
+    start();
+}
+
+void FilterEngine::appendRows()
+{
+    if (!table || tableGeneration == table->generation()) {
+        return;
+    }
+    tableGeneration = table->generation();
+
+    // Pool ids stay the same when rows are appended, so the old results still hold
+    int count = int(table->stringPool().size());
+    if (!source || count <= source->count) {
+        return;
+    }
+    if (query.isEmpty()) {
+        source.reset();
+        return;
+    }
+    auto extended = std::make_shared<Source>(*source);
+    int first = extended->count;
+    extended->append(*table, count);
+    source = extended;
+    startRun(false, first, count, QVector<int>());
+}
+
+void FilterEngine::setQuery(const QString &query)
+{
+    if (this->query == query) {
+        return;
+    }
+    this->query = query;
+    start();
+    if (query.isEmpty()) {
+        emit resultsReady();
+    }
+}
+
+void FilterEngine::cancelRuns()
+{
+    for (const auto &run : runs) {
+        run->cancelled.store(1);
+    }
+    runs.clear();
+}
+
+void FilterEngine::start()
+{
+    generation++;
+    cancelRuns();
+
+    // Not emitting resultsReady() here, this may be called while the model is being reset
+    if (query.isEmpty() || !table) {
+        matched.clear();
+        return;
+    }
+
+    if (!source) {
+        auto source = std::make_shared<Source>();
+        source->append(*table, int(table->stringPool().size()));
+        this->source = source;
+    }
+
+    // Everything matching an extended plain query also matched the shorter one
+    QString needle = caseSensitivity == Qt::CaseInsensitive ? query.toCaseFolded() : query;
+    bool plain = ColumnarTable::isPlainPattern(QRegExp(query, caseSensitivity, QRegExp::Wildcard));
+    if (plain && lastValid && needle.contains(lastNeedle) && lastCount <= source->count) {
+        startRun(true, lastCount, source->count, lastIds);
+    } else {
+        startRun(true, 0, source->count, QVector<int>());
+    }
+}
+
+void FilterEngine::startRun(bool replace, int first, int last,
+                            const QVector<int> &extraCandidates)
+{
+    auto run = std::make_shared<Run>();
+    run->source = source;
+    run->regExp = QRegExp(query, caseSensitivity, QRegExp::Wildcard);
+    run->plain = ColumnarTable::isPlainPattern(run->regExp);
+    run->needle = caseSensitivity == Qt::CaseInsensitive ? query.toCaseFolded() : query;
+    run->replace = replace;
+    run->count = last;
+
+    run->candidates = extraCandidates;
+    run->candidates.reserve(extraCandidates.size() + last - first);
+    for (int id = first; id < last; id++) {
+        run->candidates.append(id);
+    }
+    run->hits.assign(run->candidates.size(), 0);
+    run->chunkCount = (run->candidates.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    runs.append(run);
+    pool.start(new RunTask(this, generation, run));
+}
+
+void FilterEngine::runFinished(int generation, QVector<int> ids)
+{
+    if (generation != this->generation || runs.isEmpty()) {
+        return;
+    }
+    // The pool runs one task at a time, so runs finish in the order they were started
+    std::shared_ptr<Run> run = runs.takeFirst();
+
+    if (run->replace) {
+        matched.assign(run->count, 0);
+    } else if (int(matched.size()) < run->count) {
+        matched.resize(run->count, 0);
+    }
+    for (int id : ids) {
+        matched[id] = 1;
+    }
+
+    if (!run->plain) {
+        lastValid = false;
+    } else if (run->replace) {
+        lastNeedle = run->needle;
+        lastIds = ids;
+        lastCount = run->count;
+        lastValid = true;
+    } else if (lastValid && lastNeedle == run->needle) {
+        lastIds += ids;
+        lastCount = run->count;
+    }
+    emit resultsReady();
+}
@@ -0,0 +1,117 @@
+#ifndef FILTERENGINE_H
+#define FILTERENGINE_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QRegExp>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+#include "utils/ColumnarTable.h"
+
+/*!
+ * \brief Matches a filter query against one string column of a ColumnarTable
+ *
+ * The unique strings of the table are copied when a query starts, matching
+ * happens on worker threads in chunks of them. A new query cancels the one
+ * still running. When a plain query is extended, only the strings the previous
+ * one matched are searched again. Rows appended later only have their new
+ * strings copied and matched. Queries are wildcard patterns like
+ * QSortFilterProxyModel's setFilterWildcard().
+ */
+class FilterEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FilterEngine(QObject *parent = nullptr);
+    ~FilterEngine();
+
+    void setCaseSensitivity(Qt::CaseSensitivity caseSensitivity);
+
+    // Filters the column again if the table changed since the last call. The table has
+    // to stay alive, it is copied when a query starts.
+    void setSource(const ColumnarTable &table, int column);
+    // Like setSource() for the same table when rows were only appended to it, the
+    // rows before keep their results and only new strings are matched
+    void appendRows();
+
+    const QString &getQuery() const
+    {
+        return query;
+    }
+    bool isRunning() const
+    {
+        return !runs.isEmpty();
+    }
+
+    // Whether the row matched the last finished query, every row matches an empty query
+    bool accepts(int row) const
+    {
+        if (query.isEmpty()) {
+            return true;
+        }
+        if (!table || row >= table->rowCount()) {
+            return false;
+        }
+        int id = table->stringIds(column)[row];
+        return id < int(matched.size()) && matched[id];
+    }
+
+public slots:
+    void setQuery(const QString &query);
+
+signals:
+    // The result of a query is ready, accepts() and getRows() changed
+    void resultsReady();
+
+private slots:
+    void runFinished(int generation, QVector<int> ids);
+
+private:
+    struct Segment;
+    struct Source;
+    struct Run;
+    class RunTask;
+    class ChunkTask;
+
+    // Unique strings matched per chunk
+    static const int CHUNK_SIZE = 4096;
+
+    // Runs one query at a time, the chunks go to the global pool
+    QThreadPool pool;
+
+    Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive;
+    const ColumnarTable *table = nullptr;
+    int tableGeneration = -1;
+    int column = -1;
+    std::shared_ptr<const Source> source;
+
+    QString query;
+    int generation = 0;
+    // Runs of the current query, the one for all strings followed by those for appended ones
+    QList<std::shared_ptr<Run>> runs;
+    // Per pool id whether its string matched the last finished query
+    std::vector<char> matched;
+
+    // Last finished plain query, the pool ids of the strings it matched and how
+    // many strings of the pool it covers
+    QString lastNeedle;
+    bool lastValid = false;
+    QVector<int> lastIds;
+    int lastCount = 0;
+
+    void start();
+    void cancelRuns();
+    // Matches the strings with pool ids [first, last) and extraCandidates. A replacing
+    // run's results take the place of the previous ones, others are added to them.
+    void startRun(bool replace, int first, int last, const QVector<int> &extraCandidates);
+};
+
+#endif // FILTERENGINE_H
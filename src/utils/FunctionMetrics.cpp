@@ -0,0 +1,137 @@
+#include "FunctionMetrics.h"
+#include "AddressRangeIndex.h"
+
+#include <QHash>
+
+#include <cstring>
+#include <vector>
+
+FunctionMetricsJob::FunctionMetricsJob(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<QVector<FunctionMetrics>>();
+    pool.setMaxThreadCount(1);
+}
+
+FunctionMetricsJob::~FunctionMetricsJob()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+void FunctionMetricsJob::start()
+{
+    // Each task gets its own token, so starting a new one never revives an older one
+    cancel();
+    std::shared_ptr<QAtomicInt> token = std::make_shared<QAtomicInt>(0);
+    cancelled = token;
+    FunctionMetricsTask *task = new FunctionMetricsTask(token);
+    connect(task, &FunctionMetricsTask::finished, this,
+    [this, token](const QVector<FunctionMetrics> &metrics) {
+        // The result may have been queued before the task was cancelled
+        if (!token->load()) {
+            emit metricsReady(metrics);
+        }
+    });
+    pool.start(task);
+}
+
+void FunctionMetricsJob::cancel()
+{
+    if (cancelled) {
+        cancelled->store(1);
+    }
+}
+
+FunctionMetricsTask::FunctionMetricsTask(const std::shared_ptr<QAtomicInt> &cancelled)
+    : cancelled(cancelled)
+{
+}
+
+void FunctionMetricsTask::run()
+{
+    struct Ref {
+        RVA at;
+        RVA addr;
+        bool call;
+        bool string;
+    };
+
+    QVector<FunctionMetrics> metrics;
+    // Innermost block containing each address
+    AddressRangeIndex blockIndex;
+    std::vector<Ref> refs;
+    {
+        RCoreLocked core = Core()->core();
+
+        RListIter *it;
+        RAnalFunction *fcn;
+        CutterRListForeach(core->anal->fcns, it, RAnalFunction, fcn) {
+            if (cancelled->load()) {
+                return;
+            }
+            FunctionMetrics function;
+            function.offset = fcn->addr;
+            function.basicBlocks = r_list_length(fcn->bbs);
+            function.complexity = r_anal_fcn_cc(fcn);
+            function.stackFrame = fcn->maxstack;
+
+            RListIter *bbIt;
+            RAnalBlock *bb;
+            CutterRListForeach(fcn->bbs, bbIt, RAnalBlock, bb) {
+                function.instructions += bb->ninstr;
+                function.edges += (bb->jump != UT64_MAX) + (bb->fail != UT64_MAX);
+                if (bb->switch_op) {
+                    function.edges += r_list_length(bb->switch_op->cases);
+                }
+                blockIndex.add(bb->addr, bb->addr + bb->size, metrics.size());
+            }
+            metrics.append(function);
+        }
+
+        RList *xrefs = r_anal_xrefs_list(core->anal);
+        RAnalRef *ref;
+        CutterRListForeach(xrefs, it, RAnalRef, ref) {
+            bool string = false;
+            if (ref->type == R_ANAL_REF_TYPE_DATA) {
+                RFlagItem *flag = r_flag_get_i(core->flags, ref->addr);
+                string = flag && flag->name && !strncmp(flag->name, "str.", 4);
+            }
+            refs.push_back({ ref->at, ref->addr, ref->type == R_ANAL_REF_TYPE_CALL, string });
+        }
+        r_list_free(xrefs);
+    }
+
+    blockIndex.build();
+
+    QHash<RVA, int> entries;
+    entries.reserve(metrics.size());
+    for (int i = 0; i < metrics.size(); i++) {
+        entries.insert(metrics.at(i).offset, i);
+    }
+
+    for (const Ref &ref : refs) {
+        if (cancelled->load()) {
+            return;
+        }
+        int target = entries.value(ref.addr, -1);
+        if (target >= 0) {
+            metrics[target].xrefsIn++;
+        }
+        if (!ref.call && !ref.string) {
+            continue;
+        }
+        int source = blockIndex.at(ref.at);
+        if (source < 0) {
+            continue;
+        }
+        if (ref.call) {
+            metrics[source].calls++;
+        }
+        if (ref.string) {
+            metrics[source].stringRefs++;
+        }
+    }
+
+    emit finished(metrics);
+}
@@ -0,0 +1,76 @@
+#ifndef FUNCTIONMETRICS_H
+#define FUNCTIONMETRICS_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QVector>
+
+#include <memory>
+
+#include "Cutter.h"
+
+struct FunctionMetrics {
+    RVA offset = RVA_INVALID;
+    int basicBlocks = 0;
+    // Successors of all basic blocks, including switch cases
+    int edges = 0;
+    int complexity = 0;
+    int instructions = 0;
+    int calls = 0;
+    int xrefsIn = 0;
+    int stackFrame = 0;
+    // Data references to flags in the strings flagspace
+    int stringRefs = 0;
+};
+
+Q_DECLARE_METATYPE(FunctionMetrics)
+
+/*!
+ * \brief Computes FunctionMetrics for all functions in the background
+ *
+ * The basic blocks and references are copied in one pass with the core locked,
+ * everything else runs on a worker thread without holding the lock.
+ */
+class FunctionMetricsJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FunctionMetricsJob(QObject *parent = nullptr);
+    ~FunctionMetricsJob();
+
+    void start();
+
+public slots:
+    // No metricsReady() follows
+    void cancel();
+
+signals:
+    // One entry per function, in no particular order
+    void metricsReady(const QVector<FunctionMetrics> &metrics);
+
+private:
+    QThreadPool pool;
+    // Token of the latest task, set to cancel it
+    std::shared_ptr<QAtomicInt> cancelled;
+};
+
+class FunctionMetricsTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    explicit FunctionMetricsTask(const std::shared_ptr<QAtomicInt> &cancelled);
+
+    void run() override;
+
+signals:
+    void finished(const QVector<FunctionMetrics> &metrics);
+
+private:
+    std::shared_ptr<QAtomicInt> cancelled;
+};
+
+#endif // FUNCTIONMETRICS_H
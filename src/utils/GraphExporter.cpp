@@ -0,0 +1,453 @@
+#include "GraphExporter.h"
+
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QFontMetricsF>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QRegularExpression>
+#include <QSvgGenerator>
+#include <QTextStream>
+#include <QtMath>
+
+#include "utils/CachedFontMetrics.h"
+#include "utils/Configuration.h"
+#include "utils/TempConfig.h"
+
+// Empty space around the graph in images
+static const int EXPORT_MARGIN = 16;
+// Larger PNG graphs are scaled down to fit, QImage can not hold much more
+static const qreal MAX_IMAGE_SIZE = 16384;
+
+GraphExporter::GraphExporter(QObject *parent)
+    : QObject(parent)
+{
+    fetchTimer.setSingleShot(true);
+    fetchTimer.setInterval(0);
+    connect(&fetchTimer, SIGNAL(timeout()), this, SLOT(fetchGraphs()));
+}
+
+GraphExporter::~GraphExporter()
+{
+    // Tasks point to cancelled
+    cancelled.store(1);
+    pool.waitForDone();
+}
+
+bool GraphExporter::formatFromName(const QString &name, Format *format)
+{
+    QString lower = name.toLower();
+    if (lower == "svg") {
+        *format = Format::Svg;
+    } else if (lower == "png") {
+        *format = Format::Png;
+    } else if (lower == "dot") {
+        *format = Format::Dot;
+    } else if (lower == "json") {
+        *format = Format::Json;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString GraphExporter::formatExtension(Format format)
+{
+    switch (format) {
+    case Format::Svg:
+        return "svg";
+    case Format::Png:
+        return "png";
+    case Format::Dot:
+        return "dot";
+    case Format::Json:
+        return "json";
+    }
+    return QString();
+}
+
+void GraphExporter::start(const QList<FunctionDescription> &functions, const QString &directory,
+                          Format format)
+{
+    this->functions = functions;
+    this->directory = directory;
+    this->format = format;
+    cancelled.store(0);
+    running = true;
+    next = 0;
+    pending = 0;
+    exported = 0;
+    failed = 0;
+
+    style.font = Config()->getFont();
+    style.background = ConfigColor("gui.background");
+    style.blockBackground = ConfigColor("gui.alt_background");
+    style.border = ConfigColor("gui.border");
+    style.trueColor = ConfigColor("graph.true");
+    style.falseColor = ConfigColor("graph.false");
+    style.jumpColor = ConfigColor("graph.trufae");
+    style.layoutType = Config()->getGraphLayered() ? GraphLayout::LayoutType::Layered
+                       : GraphLayout::LayoutType::Medium;
+
+    emit progress(0, functions.size());
+    fetchTimer.start();
+}
+
+void GraphExporter::cancel()
+{
+    if (!running) {
+        return;
+    }
+    cancelled.store(1);
+    fetchTimer.stop();
+    // Otherwise the last running task reports the end
+    if (pending == 0) {
+        running = false;
+        emit finished(exported, failed);
+    }
+}
+
+// Reads graphs from the core and hands them to the pool, until the time budget is used up
+// or enough graphs are waiting for a worker
+void GraphExporter::fetchGraphs()
+{
+    if (cancelled.load()) {
+        return;
+    }
+
+    TempConfig tempConfig;
+    tempConfig.set("scr.html", true)
+    .set("scr.color", COLOR_MODE_16M)
+    .set("asm.bbline", false)
+    .set("asm.lines", false)
+    .set("asm.fcnlines", false);
+    int blockLength = Config()->getGraphBlockMaxChars() + Core()->getConfigb("asm.bytes") * 24 +
+                      Core()->getConfigb("asm.emu") * 10;
+
+    int maxPending = pool.maxThreadCount() * PENDING_PER_THREAD;
+    QElapsedTimer timer;
+    timer.start();
+    while (next < functions.size() && pending < maxPending
+            && timer.elapsed() < FETCH_BUDGET_MS) {
+        const FunctionDescription &function = functions[next++];
+        GraphExportTask *task = new GraphExportTask(fetchGraph(function, blockLength), style,
+                                                    QDir(directory).filePath(fileName(function)),
+                                                    format, &cancelled);
+        connect(task, &GraphExportTask::finished, this, &GraphExporter::taskFinished);
+        pending++;
+        pool.start(task);
+    }
+
+    if (next >= functions.size() && pending == 0) {
+        // Nothing to export at all
+        running = false;
+        emit finished(exported, failed);
+    } else if (next < functions.size() && pending < maxPending) {
+        fetchTimer.start();
+    }
+}
+
+GraphExporter::Graph GraphExporter::fetchGraph(const FunctionDescription &function,
+                                               int blockLength)
+{
+    Graph graph;
+    graph.name = function.name;
+    graph.offset = function.offset;
+
+    QJsonArray functions = Core()->cmdj("agJ @ " + RAddressString(function.offset)).array();
+    if (functions.isEmpty()) {
+        return graph;
+    }
+    QJsonObject func = functions.first().toObject();
+    for (QJsonValueRef blockRef : func["blocks"].toArray()) {
+        QJsonObject blockObject = blockRef.toObject();
+        RVA fail = blockObject["fail"].toVariant().toULongLong();
+        RVA jump = blockObject["jump"].toVariant().toULongLong();
+
+        // Same edges as in the graph view
+        Block block;
+        block.entry = blockObject["offset"].toVariant().toULongLong();
+        if (fail) {
+            block.false_path = fail;
+            block.exits.push_back(fail);
+        }
+        if (jump) {
+            if (fail) {
+                block.true_path = jump;
+            }
+            block.exits.push_back(jump);
+        }
+        for (QJsonValueRef opRef : blockObject["ops"].toArray()) {
+            RichTextPainter::List richText = RichTextPainter::fromHtml(
+                                                 opRef.toObject()["text"].toString());
+            block.lines.push_back(RichTextPainter::cropped(richText, blockLength, "..."));
+        }
+        graph.blocks.push_back(block);
+    }
+    return graph;
+}
+
+// The address keeps names unique, the name keeps them readable
+QString GraphExporter::fileName(const FunctionDescription &function) const
+{
+    QString name = function.name;
+    name.replace(QRegularExpression("[^A-Za-z0-9_.-]"), "_");
+    return QString("%1_%2.%3").arg(RAddressString(function.offset), name,
+                                   formatExtension(format));
+}
+
+void GraphExporter::taskFinished(bool success)
+{
+    pending--;
+    if (!cancelled.load()) {
+        if (success) {
+            exported++;
+        } else {
+            failed++;
+        }
+        emit progress(exported + failed, functions.size());
+    }
+
+    if (pending == 0 && (cancelled.load() || next >= functions.size())) {
+        running = false;
+        emit finished(exported, failed);
+    } else if (!cancelled.load() && !fetchTimer.isActive()) {
+        fetchTimer.start();
+    }
+}
+
+GraphExportTask::GraphExportTask(const GraphExporter::Graph &graph,
+                                 const GraphExporter::Style &style, const QString &fileName,
+                                 GraphExporter::Format format, const QAtomicInt *cancelled)
+    : graph(graph),
+      style(style),
+      fileName(fileName),
+      format(format),
+      cancelled(cancelled)
+{
+}
+
+void GraphExportTask::run()
+{
+    if (cancelled->load() || graph.blocks.empty()) {
+        emit finished(false);
+        return;
+    }
+
+    // Block sizes as computed by DisassemblerGraphView::prepareGraphNode()
+    CachedFontMetrics metrics(nullptr, style.font);
+    QFontMetricsF fontMetrics(style.font);
+    charWidth = fontMetrics.width('X');
+    charHeight = int(fontMetrics.height());
+    int extra = 4 * charWidth + 4;
+
+    GraphLayout::Config config;
+    config.layoutType = style.layoutType;
+    GraphLayout layout(config);
+    for (const GraphExporter::Block &block : graph.blocks) {
+        int width = 0;
+        for (const RichTextPainter::List &line : block.lines) {
+            int lineWidth = 0;
+            for (const RichTextPainter::CustomRichText_t &part : line) {
+                lineWidth += metrics.width(part.text);
+            }
+            width = qMax(width, lineWidth);
+        }
+        layout.addBlock(block.entry, int(width + extra + charWidth),
+                        int(block.lines.size()) * charHeight + extra, block.exits);
+    }
+
+    if (!layout.compute(graph.offset, cancelled)) {
+        emit finished(false);
+        return;
+    }
+    emit finished(write(layout, metrics));
+}
+
+bool GraphExportTask::write(const GraphLayout &layout, CachedFontMetrics &metrics)
+{
+    QSizeF size(layout.getWidth() + 2 * EXPORT_MARGIN, layout.getHeight() + 2 * EXPORT_MARGIN);
+
+    if (format == GraphExporter::Format::Svg) {
+        QSvgGenerator generator;
+        generator.setFileName(fileName);
+        generator.setSize(size.toSize());
+        generator.setViewBox(QRectF(QPointF(0, 0), size));
+        generator.setTitle(graph.name);
+        QPainter p;
+        if (!p.begin(&generator)) {
+            return false;
+        }
+        p.fillRect(QRectF(QPointF(0, 0), size), style.background);
+        p.translate(EXPORT_MARGIN, EXPORT_MARGIN);
+        paint(p, layout, metrics);
+        return p.end();
+    }
+
+    if (format == GraphExporter::Format::Png) {
+        qreal scale = qMin(qreal(1.0), qMin(MAX_IMAGE_SIZE / size.width(),
+                                            MAX_IMAGE_SIZE / size.height()));
+        QImage image(qCeil(size.width() * scale), qCeil(size.height() * scale),
+                     QImage::Format_RGB32);
+        if (image.isNull()) {
+            return false;
+        }
+        image.fill(style.background);
+        QPainter p(&image);
+        p.scale(scale, scale);
+        p.translate(EXPORT_MARGIN, EXPORT_MARGIN);
+        paint(p, layout, metrics);
+        p.end();
+        return image.save(fileName, "PNG");
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QByteArray data = format == GraphExporter::Format::Dot ? toDot(layout) : toJson(layout);
+    return file.write(data) == data.size();
+}
+
+static QColor edgeColor(const GraphExporter::Block &block, ut64 dest,
+                        const GraphExporter::Style &style)
+{
+    if (dest == block.true_path) {
+        return style.trueColor;
+    } else if (dest == block.false_path) {
+        return style.falseColor;
+    }
+    return style.jumpColor;
+}
+
+// Draws the graph like DisassemblerGraphView does at full detail
+void GraphExportTask::paint(QPainter &p, const GraphLayout &layout, CachedFontMetrics &metrics)
+{
+    const auto &blocks = layout.getBlocks();
+    p.setFont(style.font);
+    for (const GraphExporter::Block &block : graph.blocks) {
+        const GraphLayout::Block &lb = blocks.at(block.entry);
+        p.setPen(Qt::NoPen);
+        p.setBrush(QColor(0, 0, 0, 128));
+        p.drawRect(QRectF(lb.x + 4, lb.y + 4, lb.width + 4, lb.height + 4));
+        p.setPen(style.border);
+        p.setBrush(style.blockBackground);
+        p.drawRect(QRectF(lb.x, lb.y, lb.width, lb.height));
+
+        int x = int(lb.x + 3 * charWidth);
+        int y = int(lb.y + 2 * charWidth);
+        for (const RichTextPainter::List &line : block.lines) {
+            RichTextPainter::paintRichText(&p, x, y, int(lb.width - charWidth), charHeight, 0, line,
+                                           &metrics);
+            y += charHeight;
+        }
+    }
+
+    for (const GraphExporter::Block &block : graph.blocks) {
+        for (const GraphLayout::Edge &edge : blocks.at(block.entry).edges) {
+            QColor color = edgeColor(block, edge.dest, style);
+            p.setPen(color);
+            p.setBrush(Qt::NoBrush);
+            p.drawPolyline(edge.polyline);
+            p.setBrush(color);
+            p.drawConvexPolygon(edge.arrow_end);
+        }
+    }
+}
+
+static QString plainText(const RichTextPainter::List &line)
+{
+    QString text;
+    for (const RichTextPainter::CustomRichText_t &part : line) {
+        text += part.text;
+    }
+    return text;
+}
+
+static QString dotEscape(QString text)
+{
+    return text.replace('\\', "\\\\").replace('"', "\\\"");
+}
+
+// Positions are in points with y growing upwards as Graphviz expects them,
+// "neato -n2" renders the file without laying it out again.
+QByteArray GraphExportTask::toDot(const GraphLayout &layout) const
+{
+    const auto &blocks = layout.getBlocks();
+    int height = layout.getHeight();
+    QString dot;
+    QTextStream out(&dot);
+    out << "digraph \"" << dotEscape(graph.name) << "\" {\n";
+    out << "    graph [bgcolor=\"" << style.background.name() << "\" splines=polyline];\n";
+    out << "    node [shape=box style=filled fillcolor=\"" << style.blockBackground.name()
+        << "\" color=\"" << style.border.name() << "\" fontname=\""
+        << dotEscape(style.font.family()) << "\"];\n";
+
+    for (const GraphExporter::Block &block : graph.blocks) {
+        const GraphLayout::Block &lb = blocks.at(block.entry);
+        QString label;
+        for (const RichTextPainter::List &line : block.lines) {
+            label += dotEscape(plainText(line)) + "\\l";
+        }
+        out << "    \"" << RAddressString(block.entry) << "\" [label=\"" << label
+            << "\" pos=\"" << lb.x + lb.width / 2.0 << "," << height - (lb.y + lb.height / 2.0)
+            << "!\" width=" << lb.width / 72.0 << " height=" << lb.height / 72.0 << "];\n";
+    }
+    for (const GraphExporter::Block &block : graph.blocks) {
+        for (ut64 exit : block.exits) {
+            out << "    \"" << RAddressString(block.entry) << "\" -> \"" << RAddressString(exit)
+                << "\" [color=\"" << edgeColor(block, exit, style).name() << "\"];\n";
+        }
+    }
+    out << "}\n";
+    out.flush();
+    return dot.toUtf8();
+}
+
+QByteArray GraphExportTask::toJson(const GraphLayout &layout) const
+{
+    const auto &blocks = layout.getBlocks();
+    QJsonArray blockArray;
+    QJsonArray edgeArray;
+    for (const GraphExporter::Block &block : graph.blocks) {
+        const GraphLayout::Block &lb = blocks.at(block.entry);
+        QJsonArray lines;
+        for (const RichTextPainter::List &line : block.lines) {
+            lines.append(plainText(line));
+        }
+        QJsonObject blockObject;
+        blockObject["offset"] = qint64(block.entry);
+        blockObject["x"] = lb.x;
+        blockObject["y"] = lb.y;
+        blockObject["width"] = lb.width;
+        blockObject["height"] = lb.height;
+        blockObject["lines"] = lines;
+        blockArray.append(blockObject);
+
+        for (const GraphLayout::Edge &edge : lb.edges) {
+            QJsonArray points;
+            for (const QPointF &point : edge.polyline) {
+                points.append(QJsonArray({ point.x(), point.y() }));
+            }
+            QJsonObject edgeObject;
+            edgeObject["from"] = qint64(block.entry);
+            edgeObject["to"] = qint64(edge.dest);
+            edgeObject["color"] = edgeColor(block, edge.dest, style).name();
+            edgeObject["points"] = points;
+            edgeArray.append(edgeObject);
+        }
+    }
+
+    QJsonObject root;
+    root["name"] = graph.name;
+    root["offset"] = qint64(graph.offset);
+    root["width"] = layout.getWidth();
+    root["height"] = layout.getHeight();
+    root["blocks"] = blockArray;
+    root["edges"] = edgeArray;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
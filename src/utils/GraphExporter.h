@@ -0,0 +1,152 @@
+#ifndef GRAPHEXPORTER_H
+#define GRAPHEXPORTER_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QThreadPool>
+#include <QTimer>
+#include <QFont>
+#include <QColor>
+
+#include <vector>
+
+#include "Cutter.h"
+#include "utils/RichTextPainter.h"
+#include "widgets/GraphLayout.h"
+
+class CachedFontMetrics;
+class QPainter;
+
+/*!
+ * \brief Writes the control flow graphs of many functions to files
+ *
+ * The graphs are read from the core on the GUI thread a few functions at a time,
+ * laying them out and writing the files happens on a thread pool. Blocks look
+ * like in the graph view, using the configured font, colors and layout.
+ * No view is needed, so this also works from the command line.
+ */
+class GraphExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Format {
+        Svg,
+        Png,
+        Dot,
+        Json,
+    };
+
+    // Everything about the look of the graphs, read once on the GUI thread
+    struct Style {
+        QFont font;
+        QColor background;
+        QColor blockBackground;
+        QColor border;
+        QColor trueColor;
+        QColor falseColor;
+        QColor jumpColor;
+        GraphLayout::LayoutType layoutType = GraphLayout::LayoutType::Medium;
+    };
+
+    struct Block {
+        ut64 entry;
+        ut64 true_path = RVA_INVALID;
+        ut64 false_path = RVA_INVALID;
+        std::vector<ut64> exits;
+        std::vector<RichTextPainter::List> lines;
+    };
+
+    struct Graph {
+        QString name;
+        RVA offset;
+        std::vector<Block> blocks;
+    };
+
+    explicit GraphExporter(QObject *parent = nullptr);
+    ~GraphExporter();
+
+    // Format for a name like "svg", returns false if there is none
+    static bool formatFromName(const QString &name, Format *format);
+    static QString formatExtension(Format format);
+
+    // Writes one file per function into directory, existing files are replaced
+    void start(const QList<FunctionDescription> &functions, const QString &directory,
+               Format format);
+    bool isRunning() const
+    {
+        return running;
+    }
+
+public slots:
+    // Graphs which are already being written are finished, finished() follows
+    void cancel();
+
+signals:
+    void progress(int done, int total);
+    void finished(int exported, int failed);
+
+private slots:
+    void fetchGraphs();
+
+private:
+    // Time spent reading graphs from the core per event loop iteration
+    static const int FETCH_BUDGET_MS = 50;
+    // Graphs read ahead per worker thread
+    static const int PENDING_PER_THREAD = 4;
+
+    QThreadPool pool;
+    QTimer fetchTimer;
+    QAtomicInt cancelled;
+
+    QList<FunctionDescription> functions;
+    QString directory;
+    Format format = Format::Svg;
+    Style style;
+    bool running = false;
+    // Next function to read
+    int next = 0;
+    // Graphs handed to the pool which are not written yet
+    int pending = 0;
+    int exported = 0;
+    int failed = 0;
+
+    Graph fetchGraph(const FunctionDescription &function, int blockLength);
+    QString fileName(const FunctionDescription &function) const;
+    void taskFinished(bool success);
+};
+
+/*!
+ * \brief Lays out one graph and writes it to a file, run by GraphExporter
+ */
+class GraphExportTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    GraphExportTask(const GraphExporter::Graph &graph, const GraphExporter::Style &style,
+                    const QString &fileName, GraphExporter::Format format,
+                    const QAtomicInt *cancelled);
+
+    void run() override;
+
+signals:
+    void finished(bool success);
+
+private:
+    GraphExporter::Graph graph;
+    GraphExporter::Style style;
+    QString fileName;
+    GraphExporter::Format format;
+    const QAtomicInt *cancelled;
+    qreal charWidth = 0.0;
+    int charHeight = 0;
+
+    bool write(const GraphLayout &layout, CachedFontMetrics &metrics);
+    void paint(QPainter &p, const GraphLayout &layout, CachedFontMetrics &metrics);
+    QByteArray toDot(const GraphLayout &layout) const;
+    QByteArray toJson(const GraphLayout &layout) const;
+};
+
+#endif // GRAPHEXPORTER_H
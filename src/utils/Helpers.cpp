@@ -7,6 +7,7 @@
 #include <QtCore>
 #include <QCryptographicHash>
 #include <QTreeWidget>
+#include <QHeaderView>
 #include <QString>
 #include <QAbstractItemView>
 #include <QAbstractButton>
@@ -51,6 +52,20 @@ void adjustColumns(QTreeWidget *tw, int padding)
     adjustColumns(tw, tw->columnCount(), padding);
 }
 
+void adjustColumnsFromSample(QTreeView *tv, int columnCount, int sampleRows)
+{
+    QAbstractItemModel *model = tv->model();
+    int rows = model->rowCount();
+    int step = qMax(1, rows / qMax(1, sampleRows));
+    for (int column = 0; column != columnCount; ++column) {
+        int width = tv->header()->sectionSizeHint(column);
+        for (int row = 0; row < rows; row += step) {
+            width = qMax(width, tv->sizeHintForIndex(model->index(row, column)).width());
+        }
+        tv->setColumnWidth(column, width);
+    }
+}
+
 QTreeWidgetItem *appendRow(QTreeWidget *tw, const QString &str, const QString &str2,
                            const QString &str3, const QString &str4, const QString &str5)
 {
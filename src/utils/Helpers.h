@@ -19,6 +19,8 @@ namespace qhelpers {
 QString formatBytecount(const long bytecount);
 void adjustColumns(QTreeView *tv, int columnCount, int padding);
 void adjustColumns(QTreeWidget *tw, int padding);
+// Like adjustColumns(), but only measures about sampleRows rows spread over the whole model
+void adjustColumnsFromSample(QTreeView *tv, int columnCount, int sampleRows);
 
 QTreeWidgetItem *appendRow(QTreeWidget *tw, const QString &str, const QString &str2 = QString(),
                            const QString &str3 = QString(), const QString &str4 = QString(), const QString &str5 = QString());
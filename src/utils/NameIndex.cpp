@@ -0,0 +1,205 @@
+#include "NameIndex.h"
+
+#include <algorithm>
+
+void NameIndex::add(const QString &name)
+{
+    if (name.isEmpty()) {
+        return;
+    }
+
+    auto it = ids.constFind(name);
+    if (it != ids.constEnd()) {
+        Entry &entry = entries[it.value()];
+        if (entry.references++ == 0) {
+            live++;
+        }
+        return;
+    }
+
+    int id = int(entries.size());
+    Entry entry;
+    entry.name = name;
+    entry.folded = name.toCaseFolded();
+    entry.references = 1;
+    // Ids only grow, so a gram seen twice in this name was just added
+    auto post = [id](std::vector<int> &list) {
+        if (list.empty() || list.back() != id) {
+            list.push_back(id);
+        }
+    };
+    for (int i = 0; i < entry.folded.length(); i++) {
+        post(unigrams[entry.folded[i].unicode()]);
+        if (i + 1 < entry.folded.length()) {
+            post(bigrams[bigramAt(entry.folded, i)]);
+        }
+        if (i + 2 < entry.folded.length()) {
+            post(trigrams[trigramAt(entry.folded, i)]);
+        }
+    }
+    entries.push_back(entry);
+    ids.insert(name, id);
+    live++;
+
+    if (sortedValid) {
+        auto position = std::upper_bound(sorted.begin(), sorted.end(), id, [this](int a, int b) {
+            return foldedLessThan(a, b);
+        });
+        sorted.insert(position, id);
+    }
+}
+
+void NameIndex::sort()
+{
+    sorted.resize(entries.size());
+    for (size_t i = 0; i < sorted.size(); i++) {
+        sorted[i] = int(i);
+    }
+    std::sort(sorted.begin(), sorted.end(), [this](int a, int b) {
+        return foldedLessThan(a, b);
+    });
+    sortedValid = true;
+}
+
+void NameIndex::remove(const QString &name)
+{
+    // The entry stays in the gram lists, unreferenced ones are skipped by find()
+    auto it = ids.constFind(name);
+    if (it == ids.constEnd()) {
+        return;
+    }
+    Entry &entry = entries[it.value()];
+    if (entry.references > 0 && --entry.references == 0) {
+        live--;
+    }
+}
+
+QStringList NameIndex::find(const QString &query, int limit) const
+{
+    QString needle = query.toCaseFolded();
+    if (needle.isEmpty() || limit <= 0) {
+        return QStringList();
+    }
+
+    struct Match {
+        int rank;
+        int length;
+        int id;
+    };
+    auto better = [this](const Match & a, const Match & b) {
+        if (a.rank != b.rank) {
+            return a.rank < b.rank;
+        }
+        if (a.length != b.length) {
+            return a.length < b.length;
+        }
+        return entries[a.id].folded < entries[b.id].folded;
+    };
+
+    // Max heap by better(), so the worst of the best matches is on top
+    std::vector<Match> best;
+    auto consider = [&](int id, bool skipPrefixes) {
+        const Entry &entry = entries[id];
+        if (entry.references == 0) {
+            return;
+        }
+        int pos = entry.folded.indexOf(needle);
+        if (pos < 0 || (pos == 0 && skipPrefixes)) {
+            return;
+        }
+        Match match;
+        match.length = entry.folded.length();
+        match.id = id;
+        if (pos == 0) {
+            match.rank = match.length == needle.length() ? 0 : 1;
+        } else {
+            match.rank = entry.folded[pos - 1].isLetterOrNumber() ? 3 : 2;
+        }
+        if (int(best.size()) < limit) {
+            best.push_back(match);
+            std::push_heap(best.begin(), best.end(), better);
+        } else if (better(match, best.front())) {
+            std::pop_heap(best.begin(), best.end(), better);
+            best.back() = match;
+            std::push_heap(best.begin(), best.end(), better);
+        }
+    };
+
+    if (needle.length() < 3) {
+        // Names starting with the needle follow each other in sorted, the exact match first
+        if (sortedValid) {
+            auto it = std::lower_bound(sorted.begin(), sorted.end(), needle,
+            [this](int id, const QString & value) {
+                return entries[id].folded < value;
+            });
+            for (int scanned = 0; it != sorted.end() && scanned < SHORT_QUERY_SCAN_LIMIT;
+                    ++it, scanned++) {
+                if (!entries[*it].folded.startsWith(needle)) {
+                    break;
+                }
+                consider(*it, false);
+            }
+        }
+        // Then the names containing it elsewhere, prefixes were ranked above
+        const std::vector<int> *postings = nullptr;
+        if (needle.length() == 1) {
+            auto it = unigrams.constFind(needle[0].unicode());
+            postings = it == unigrams.constEnd() ? nullptr : &it.value();
+        } else {
+            auto it = bigrams.constFind(bigramAt(needle, 0));
+            postings = it == bigrams.constEnd() ? nullptr : &it.value();
+        }
+        if (postings) {
+            size_t count = std::min(postings->size(), size_t(SHORT_QUERY_SCAN_LIMIT));
+            for (size_t i = 0; i < count; i++) {
+                consider((*postings)[i], sortedValid);
+            }
+        }
+    } else {
+        // Every match contains all trigrams of the needle, the rarest one has the fewest names
+        const std::vector<int> *rarest = nullptr;
+        for (int i = 0; i + 2 < needle.length(); i++) {
+            auto it = trigrams.constFind(trigramAt(needle, i));
+            if (it == trigrams.constEnd()) {
+                return QStringList();
+            }
+            if (!rarest || it.value().size() < rarest->size()) {
+                rarest = &it.value();
+            }
+        }
+        for (int id : *rarest) {
+            consider(id, false);
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end(), better);
+    QStringList names;
+    names.reserve(int(best.size()));
+    for (const Match &match : best) {
+        names.append(entries[match.id].name);
+    }
+    return names;
+}
+
+NameIndexTask::NameIndexTask(const std::shared_ptr<NameIndex> &index,
+                             const std::shared_ptr<QMap<RVA, QString>> &functions)
+    : index(index),
+      functions(functions)
+{
+}
+
+void NameIndexTask::run()
+{
+    for (const FlagDescription &flag : Core()->getAllFlags()) {
+        index->add(flag.name);
+    }
+    for (const FunctionDescription &function : Core()->getAllFunctions()) {
+        index->add(function.name);
+        functions->insert(function.offset, function.name);
+    }
+    for (const SymbolDescription &symbol : Core()->getAllSymbols()) {
+        index->add(symbol.name);
+    }
+    index->sort();
+    emit finished();
+}
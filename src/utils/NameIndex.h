@@ -0,0 +1,111 @@
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMap>
+
+#include <memory>
+#include <vector>
+
+#include "Cutter.h"
+
+/*!
+ * \brief Case insensitive substring search over a large set of names
+ *
+ * Every name is listed under each trigram of its case folded form, so a query
+ * of three or more characters only checks the names sharing its rarest
+ * trigram. Shorter queries may match most names, so they check a limited
+ * number of names starting with them, found in the names sorted by their case
+ * folded form, and then a limited number of the names containing them, from
+ * unigram and bigram lists. Names are counted, one added twice has to be
+ * removed twice, as a function and a flag may have the same name.
+ */
+class NameIndex
+{
+public:
+    void add(const QString &name);
+    void remove(const QString &name);
+
+    // Sorts the names for prefix matches of queries shorter than three characters, names
+    // added afterwards are inserted in order. Meant to be called once after adding in bulk.
+    void sort();
+
+    int count() const
+    {
+        return live;
+    }
+
+    /*!
+     * \brief The best limit names containing query
+     *
+     * Exact matches come first, then names starting with query, then names where it
+     * starts a word, then all others. Shorter names go before longer ones. Queries
+     * shorter than three characters only rank the first SHORT_QUERY_SCAN_LIMIT names
+     * starting with them and containing them.
+     */
+    QStringList find(const QString &query, int limit) const;
+
+private:
+    static const int SHORT_QUERY_SCAN_LIMIT = 10000;
+
+    struct Entry {
+        QString name;
+        QString folded;
+        int references = 0;
+    };
+
+    std::vector<Entry> entries;
+    QHash<QString, int> ids;
+    // Ids of the names containing each trigram, ascending
+    QHash<quint64, std::vector<int>> trigrams;
+    // Same for single characters and pairs of characters, for short queries
+    QHash<ushort, std::vector<int>> unigrams;
+    QHash<quint32, std::vector<int>> bigrams;
+    // Ids ordered by their case folded names, valid once sort() was called
+    std::vector<int> sorted;
+    bool sortedValid = false;
+    int live = 0;
+
+    bool foldedLessThan(int a, int b) const
+    {
+        return entries[a].folded < entries[b].folded;
+    }
+
+    static quint32 bigramAt(const QString &folded, int i)
+    {
+        return quint32(folded[i].unicode()) << 16 | quint32(folded[i + 1].unicode());
+    }
+
+    static quint64 trigramAt(const QString &folded, int i)
+    {
+        return quint64(folded[i].unicode()) << 32 | quint64(folded[i + 1].unicode()) << 16
+               | quint64(folded[i + 2].unicode());
+    }
+};
+
+/*!
+ * \brief Fills a NameIndex with all flag, function and symbol names on a worker thread
+ */
+class NameIndexTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    NameIndexTask(const std::shared_ptr<NameIndex> &index,
+                  const std::shared_ptr<QMap<RVA, QString>> &functions);
+
+    void run() override;
+
+signals:
+    void finished();
+
+private:
+    std::shared_ptr<NameIndex> index;
+    std::shared_ptr<QMap<RVA, QString>> functions;
+};
+
+#endif // NAMEINDEX_H
@@ -4,6 +4,7 @@
 #include <QPainter>
 #include <QTextBlock>
 #include <QTextFragment>
+#include <QVector>
 
 //TODO: fix performance (possibly use QTextLayout?)
 void RichTextPainter::paintRichText(QPainter *painter, int x, int y, int w, int h, int xinc,
@@ -135,6 +136,208 @@ RichTextPainter::List RichTextPainter::fromTextDocument(const QTextDocument &doc
     return r;
 }
 
+// Parses "#rrggbb", color names and "rgb(r, g, b)"
+static QColor parseHtmlColor(const QStringRef &value)
+{
+    if (value.startsWith(QLatin1String("rgb("), Qt::CaseInsensitive) && value.endsWith(')')) {
+        QVector<QStringRef> parts = value.mid(4, value.size() - 5).split(',');
+        if (parts.size() == 3) {
+            return QColor(parts[0].trimmed().toInt(), parts[1].trimmed().toInt(),
+                          parts[2].trimmed().toInt());
+        }
+        return QColor();
+    }
+    return QColor(value.toString());
+}
+
+static QChar parseHtmlEntity(const QStringRef &entity)
+{
+    if (entity == QLatin1String("nbsp")) {
+        return ' ';
+    } else if (entity == QLatin1String("lt")) {
+        return '<';
+    } else if (entity == QLatin1String("gt")) {
+        return '>';
+    } else if (entity == QLatin1String("amp")) {
+        return '&';
+    } else if (entity == QLatin1String("quot")) {
+        return '"';
+    } else if (entity == QLatin1String("apos")) {
+        return '\'';
+    } else if (entity.startsWith('#')) {
+        bool ok;
+        uint code = entity.startsWith(QLatin1String("#x"), Qt::CaseInsensitive)
+                    ? entity.mid(2).toUInt(&ok, 16) : entity.mid(1).toUInt(&ok, 10);
+        if (ok && code <= 0xffff) {
+            return QChar(ushort(code));
+        }
+    }
+    return QChar();
+}
+
+RichTextPainter::List RichTextPainter::fromHtml(const QString &html)
+{
+    struct Style {
+        QColor color;
+        QColor background;
+
+        bool operator!=(const Style &other) const
+        {
+            return color != other.color || background != other.background;
+        }
+    };
+
+    List r;
+    // Styles of the currently open tags, the first one is the default
+    std::vector<Style> styles(1);
+    Style textStyle;
+    QString text;
+    // Like QTextDocument, whitespace is collapsed and dropped at the start
+    bool lastSpace = true;
+
+    auto flush = [&]() {
+        if (text.isEmpty()) {
+            return;
+        }
+        CustomRichText_t part;
+        part.text = text;
+        part.textColor = textStyle.color;
+        part.textBackground = textStyle.background;
+        bool hasForeground = textStyle.color.isValid();
+        bool hasBackground = textStyle.background.isValid();
+        if (hasForeground && !hasBackground) {
+            part.flags = FlagColor;
+        } else if (!hasForeground && hasBackground) {
+            part.flags = FlagBackground;
+        } else if (hasForeground && hasBackground) {
+            part.flags = FlagAll;
+        } else {
+            part.flags = FlagNone;
+        }
+        r.push_back(part);
+        text.clear();
+    };
+    auto append = [&](QChar c) {
+        if (styles.back() != textStyle) {
+            flush();
+            textStyle = styles.back();
+        }
+        text += c;
+    };
+
+    int size = html.size();
+    int pos = 0;
+    while (pos < size) {
+        QChar c = html[pos];
+        if (c == '<') {
+            int end = html.indexOf('>', pos);
+            if (end < 0) {
+                break;
+            }
+            QStringRef tag = html.midRef(pos + 1, end - pos - 1).trimmed();
+            pos = end + 1;
+
+            if (tag.startsWith('/')) {
+                if (styles.size() > 1) {
+                    styles.pop_back();
+                }
+                continue;
+            }
+            int nameEnd = 0;
+            while (nameEnd < tag.size() && !tag[nameEnd].isSpace() && tag[nameEnd] != '/') {
+                nameEnd++;
+            }
+            QStringRef name = tag.left(nameEnd);
+            if (tag.endsWith('/') || name.compare(QLatin1String("br"), Qt::CaseInsensitive) == 0) {
+                continue;
+            }
+
+            // Attributes, name=value with optionally quoted values
+            Style style = styles.back();
+            int i = nameEnd;
+            while (i < tag.size()) {
+                while (i < tag.size() && tag[i].isSpace()) {
+                    i++;
+                }
+                int attrStart = i;
+                while (i < tag.size() && tag[i] != '=' && !tag[i].isSpace()) {
+                    i++;
+                }
+                QStringRef attr = tag.mid(attrStart, i - attrStart);
+                if (i >= tag.size() || tag[i] != '=') {
+                    continue;
+                }
+                i++;
+                QStringRef value;
+                if (i < tag.size() && (tag[i] == '\'' || tag[i] == '"')) {
+                    QChar quote = tag[i++];
+                    int valueStart = i;
+                    while (i < tag.size() && tag[i] != quote) {
+                        i++;
+                    }
+                    value = tag.mid(valueStart, i - valueStart);
+                    i++;
+                } else {
+                    int valueStart = i;
+                    while (i < tag.size() && !tag[i].isSpace()) {
+                        i++;
+                    }
+                    value = tag.mid(valueStart, i - valueStart);
+                }
+
+                if (attr.compare(QLatin1String("color"), Qt::CaseInsensitive) == 0) {
+                    style.color = parseHtmlColor(value);
+                } else if (attr.compare(QLatin1String("bgcolor"), Qt::CaseInsensitive) == 0) {
+                    style.background = parseHtmlColor(value);
+                } else if (attr.compare(QLatin1String("style"), Qt::CaseInsensitive) == 0) {
+                    for (const QStringRef &declaration : value.split(';', QString::SkipEmptyParts)) {
+                        int colon = declaration.indexOf(':');
+                        if (colon < 0) {
+                            continue;
+                        }
+                        QStringRef property = declaration.left(colon).trimmed();
+                        QStringRef propertyValue = declaration.mid(colon + 1).trimmed();
+                        if (property.compare(QLatin1String("color"), Qt::CaseInsensitive) == 0) {
+                            style.color = parseHtmlColor(propertyValue);
+                        } else if (property.compare(QLatin1String("background-color"), Qt::CaseInsensitive) == 0
+                                   || property.compare(QLatin1String("background"), Qt::CaseInsensitive) == 0) {
+                            style.background = parseHtmlColor(propertyValue);
+                        }
+                    }
+                }
+            }
+            styles.push_back(style);
+        } else if (c == '&') {
+            int end = html.indexOf(';', pos);
+            QChar decoded;
+            if (end > pos && end - pos <= 8) {
+                decoded = parseHtmlEntity(html.midRef(pos + 1, end - pos - 1));
+            }
+            if (decoded.isNull()) {
+                append(c);
+                pos++;
+            } else {
+                append(decoded);
+                pos = end + 1;
+            }
+            lastSpace = false;
+        } else if (c.isSpace()) {
+            if (!lastSpace) {
+                append(' ');
+            }
+            lastSpace = true;
+            pos++;
+        } else {
+            append(c);
+            lastSpace = false;
+            pos++;
+        }
+    }
+    flush();
+
+    return r;
+}
+
 RichTextPainter::List RichTextPainter::cropped(const RichTextPainter::List &richText, int maxCols,
                                                const QString &indicator, bool *croppedOut)
 {
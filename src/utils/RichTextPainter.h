@@ -40,6 +40,9 @@ public:
     static void htmlRichText(const List &richText, QString &textHtml, QString &textPlain);
 
     static List fromTextDocument(const QTextDocument &doc);
+    // Same result as fromTextDocument() for the colored HTML of radare2 (scr.html),
+    // without building a document
+    static List fromHtml(const QString &html);
 
     static List cropped(const List &richText, int maxCols, const QString &indicator = nullptr,
                         bool *croppedOut = nullptr);
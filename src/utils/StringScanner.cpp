@@ -0,0 +1,423 @@
+#include "StringScanner.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STRINGSCANNER_SSE2
+#include <emmintrin.h>
+#endif
+
+// Longer runs are cut into several strings, so the part of a block carried over stays small
+static const size_t MAX_STRING_SIZE = 64 * 1024;
+
+static inline bool isTextAscii(ut8 c)
+{
+    return (c >= 0x20 && c < 0x7f) || c == '\t' || c == '\n' || c == '\r';
+}
+
+#ifdef STRINGSCANNER_SSE2
+// Bit i is set if byte i is printable ASCII, tab, line feed or carriage return
+static inline int textMask(__m128i bytes)
+{
+    // Bytes from 0x80 on are negative, so one signed range check covers 0x20 to 0x7e
+    __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(0x1f)),
+                                      _mm_cmplt_epi8(bytes, _mm_set1_epi8(0x7f)));
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t')),
+                                 _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')),
+                                              _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r'))));
+    return _mm_movemask_epi8(_mm_or_si128(printable, space));
+}
+#endif
+
+// Size of the text character at data, 0 if there is none, -1 if the buffer ends within it
+static int utf8CharSize(const ut8 *data, size_t available)
+{
+    ut8 c = data[0];
+    if (c < 0x80) {
+        return isTextAscii(c) ? 1 : 0;
+    }
+
+    int size;
+    ut32 min;
+    ut32 codePoint;
+    if ((c & 0xe0) == 0xc0) {
+        size = 2;
+        min = 0x80;
+        codePoint = c & 0x1f;
+    } else if ((c & 0xf0) == 0xe0) {
+        size = 3;
+        min = 0x800;
+        codePoint = c & 0x0f;
+    } else if ((c & 0xf8) == 0xf0) {
+        size = 4;
+        min = 0x10000;
+        codePoint = c & 0x07;
+    } else {
+        return 0;
+    }
+    for (int i = 1; i < size; i++) {
+        if (size_t(i) >= available) {
+            return -1;
+        }
+        if ((data[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (data[i] & 0x3f);
+    }
+
+    // Overlong forms, surrogates, C1 controls and code points beyond Unicode are no text
+    if (codePoint < min || (codePoint >= 0xd800 && codePoint < 0xe000) || codePoint > 0x10ffff
+            || codePoint < 0xa0) {
+        return 0;
+    }
+    return size;
+}
+
+// ASCII and UTF-8 strings, returns where to continue
+static size_t scanUtf8(const ut8 *data, size_t size, int minLength, bool final, size_t i,
+                       std::vector<StringScanner::Match> &matches)
+{
+    bool inRun = false;
+    bool multibyte = false;
+    size_t runStart = 0;
+    int runLength = 0;
+    auto finishRun = [&](size_t end) {
+        if (inRun && runLength >= minLength) {
+            StringScanner::Match match;
+            match.offset = runStart;
+            match.size = end - runStart;
+            match.length = runLength;
+            match.encoding = multibyte ? StringScanner::Encoding::Utf8
+                             : StringScanner::Encoding::Ascii;
+            matches.push_back(match);
+        }
+        inRun = false;
+    };
+
+    while (i < size) {
+#ifdef STRINGSCANNER_SSE2
+        if (size - i >= 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            int text = textMask(bytes);
+            // Nothing but control characters, no string can start here
+            if (!inRun && (text | _mm_movemask_epi8(bytes)) == 0) {
+                i += 16;
+                continue;
+            }
+            if (inRun && text == 0xffff && i + 16 - runStart <= MAX_STRING_SIZE) {
+                runLength += 16;
+                i += 16;
+                continue;
+            }
+        }
+#endif
+        if (inRun && i - runStart >= MAX_STRING_SIZE) {
+            finishRun(i);
+        }
+
+        int charSize = utf8CharSize(data + i, size - i);
+        if (charSize < 0) {
+            if (!final) {
+                // Wait for the rest of the character
+                break;
+            }
+            charSize = 0;
+        }
+        if (charSize == 0) {
+            finishRun(i);
+            i++;
+            continue;
+        }
+        if (!inRun) {
+            inRun = true;
+            multibyte = false;
+            runStart = i;
+            runLength = 0;
+        }
+        runLength++;
+        multibyte |= charSize > 1;
+        i += charSize;
+    }
+
+    if (final) {
+        finishRun(size);
+        return size;
+    }
+    return inRun ? runStart : i;
+}
+
+// ASCII range UTF-16 strings, returns where to continue
+static size_t scanUtf16(const ut8 *data, size_t size, int minLength, bool final, bool bigEndian,
+                        size_t i, std::vector<StringScanner::Match> &matches)
+{
+    bool inRun = false;
+    size_t runStart = 0;
+    int runLength = 0;
+    auto finishRun = [&]() {
+        if (inRun && runLength >= minLength) {
+            size_t end = runStart + 2 * size_t(runLength);
+            // Shifted by one byte, the same characters are also a little endian string
+            bool littleEndianToo = bigEndian && end < size && data[end] == 0;
+            if (!littleEndianToo) {
+                StringScanner::Match match;
+                match.offset = runStart;
+                match.size = end - runStart;
+                match.length = runLength;
+                match.encoding = bigEndian ? StringScanner::Encoding::Utf16Be
+                                 : StringScanner::Encoding::Utf16Le;
+                matches.push_back(match);
+            }
+        }
+        inRun = false;
+    };
+
+    int charByte = bigEndian ? 1 : 0;
+    int zeroByte = bigEndian ? 0 : 1;
+    while (i + 1 < size) {
+#ifdef STRINGSCANNER_SSE2
+        if (!inRun && size - i >= 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            // Without a zero byte no character can start in the first 15 bytes
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128())) == 0) {
+                i += 15;
+                continue;
+            }
+        }
+#endif
+        if (inRun && 2 * size_t(runLength) >= MAX_STRING_SIZE) {
+            finishRun();
+        }
+
+        if (data[i + zeroByte] == 0 && isTextAscii(data[i + charByte])) {
+            if (!inRun) {
+                inRun = true;
+                runStart = i;
+                runLength = 0;
+            }
+            runLength++;
+            i += 2;
+        } else {
+            finishRun();
+            i++;
+        }
+    }
+
+    if (final) {
+        finishRun();
+        return size;
+    }
+    return inRun ? runStart : i;
+}
+
+void StringScanner::scan(const ut8 *data, size_t size, int minLength, bool final,
+                         Position &position, std::vector<Match> &matches)
+{
+    size_t first = matches.size();
+    position.utf8 = scanUtf8(data, size, minLength, final, position.utf8, matches);
+    position.utf16Le = scanUtf16(data, size, minLength, final, false, position.utf16Le, matches);
+    position.utf16Be = scanUtf16(data, size, minLength, final, true, position.utf16Be, matches);
+    std::sort(matches.begin() + first, matches.end(), [](const Match & a, const Match & b) {
+        return a.offset < b.offset;
+    });
+}
+
+QString StringScanner::encodingName(Encoding encoding)
+{
+    switch (encoding) {
+    case Encoding::Ascii:
+        return QStringLiteral("ascii");
+    case Encoding::Utf8:
+        return QStringLiteral("utf8");
+    case Encoding::Utf16Le:
+        return QStringLiteral("utf16le");
+    case Encoding::Utf16Be:
+        return QStringLiteral("utf16be");
+    }
+    return QString();
+}
+
+int StringScanner::defaultMinLength()
+{
+    int minLength = Core()->getConfigi("bin.minstr");
+    // Most bin plugins of r2 use 4 when bin.minstr is not set
+    return minLength > 0 ? minLength : 4;
+}
+
+QList<SectionDescription> StringScanner::defaultSections()
+{
+    QList<SectionDescription> sections = Core()->getAllSections();
+    if (!sections.isEmpty()) {
+        return sections;
+    }
+
+    // Raw files have no sections, the whole file is scanned where it is mapped
+    RCoreLocked core = Core()->core();
+    RIODesc *desc = core->io ? core->io->desc : nullptr;
+    if (!desc) {
+        return sections;
+    }
+    SectionDescription file;
+    file.vaddr = Core()->math("$M");
+    file.paddr = 0;
+    file.size = r_io_desc_size(desc);
+    file.vsize = file.size;
+    sections.append(file);
+    return sections;
+}
+
+StringScanner::StringScanner(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<QList<StringDescription>>();
+}
+
+StringScanner::~StringScanner()
+{
+    // Tasks point to cancelled
+    cancelled.store(1);
+    pool.waitForDone();
+}
+
+void StringScanner::start(const QList<SectionDescription> &sections, int minLength)
+{
+    if (running) {
+        return;
+    }
+
+    QList<SectionDescription> sorted;
+    for (const SectionDescription &section : sections) {
+        if (section.vsize > 0) {
+            sorted.append(section);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(),
+    [](const SectionDescription & a, const SectionDescription & b) {
+        return a.vaddr < b.vaddr;
+    });
+
+    // Overlapping sections are scanned once, as one range
+    cancelled.store(0);
+    int i = 0;
+    while (i < sorted.count()) {
+        RVA from = sorted[i].vaddr;
+        RVA to = from + sorted[i].vsize;
+        QList<SectionDescription> rangeSections;
+        while (i < sorted.count() && sorted[i].vaddr < to) {
+            to = qMax(to, sorted[i].vaddr + sorted[i].vsize);
+            rangeSections.append(sorted[i]);
+            i++;
+        }
+
+        StringScanTask *task = new StringScanTask(from, to, rangeSections, minLength, &cancelled);
+        connect(task, &StringScanTask::stringsFound, this, &StringScanner::stringsFound);
+        connect(task, &StringScanTask::finished, this, &StringScanner::taskFinished);
+        pending++;
+        pool.start(task);
+    }
+
+    running = pending > 0;
+    if (!running) {
+        emit finished();
+    }
+}
+
+void StringScanner::cancel()
+{
+    cancelled.store(1);
+}
+
+void StringScanner::taskFinished()
+{
+    pending--;
+    if (pending == 0) {
+        running = false;
+        emit finished();
+    }
+}
+
+StringScanTask::StringScanTask(RVA from, RVA to, const QList<SectionDescription> &sections,
+                               int minLength, const QAtomicInt *cancelled)
+    : from(from),
+      to(to),
+      sections(sections),
+      minLength(minLength),
+      cancelled(cancelled)
+{
+}
+
+QString StringScanTask::sectionName(RVA addr) const
+{
+    for (const SectionDescription &section : sections) {
+        if (addr >= section.vaddr && addr < section.vaddr + section.vsize) {
+            return section.name;
+        }
+    }
+    return QString();
+}
+
+void StringScanTask::run()
+{
+    // Holds the current block and the unfinished strings of the previous one
+    QByteArray buffer;
+    RVA bufferStart = from;
+    StringScanner::Position position;
+    std::vector<StringScanner::Match> matches;
+
+    RVA next = from;
+    while (next < to && !cancelled->load()) {
+        int length = int(qMin<RVA>(BLOCK_SIZE, to - next));
+        int old = buffer.size();
+        buffer.resize(old + length);
+        {
+            RCoreLocked core = Core()->core();
+            r_io_read_at(core->io, next, reinterpret_cast<ut8 *>(buffer.data()) + old, length);
+        }
+        next += length;
+        bool final = next >= to;
+
+        const ut8 *data = reinterpret_cast<const ut8 *>(buffer.constData());
+        matches.clear();
+        StringScanner::scan(data, size_t(buffer.size()), minLength, final, position, matches);
+
+        QList<StringDescription> strings;
+        strings.reserve(int(matches.size()));
+        for (const StringScanner::Match &match : matches) {
+            StringDescription string;
+            string.vaddr = bufferStart + match.offset;
+            string.type = StringScanner::encodingName(match.encoding);
+            string.length = ut32(match.length);
+            string.size = ut32(match.size);
+            string.section = sectionName(string.vaddr);
+            const ut8 *bytes = data + match.offset;
+            switch (match.encoding) {
+            case StringScanner::Encoding::Ascii:
+            case StringScanner::Encoding::Utf8:
+                string.string = QString::fromUtf8(reinterpret_cast<const char *>(bytes),
+                                                  int(match.size));
+                break;
+            case StringScanner::Encoding::Utf16Le:
+            case StringScanner::Encoding::Utf16Be: {
+                int charByte = match.encoding == StringScanner::Encoding::Utf16Be ? 1 : 0;
+                string.string.reserve(match.length);
+                for (int c = 0; c < match.length; c++) {
+                    string.string.append(QLatin1Char(char(bytes[2 * c + charByte])));
+                }
+                break;
+            }
+            }
+            strings.append(string);
+        }
+        if (!strings.isEmpty()) {
+            emit stringsFound(strings);
+        }
+
+        // Only keep the part unfinished strings may continue in
+        size_t consumed = final ? size_t(buffer.size()) : position.min();
+        buffer.remove(0, int(consumed));
+        bufferStart += consumed;
+        position.utf8 -= consumed;
+        position.utf16Le -= consumed;
+        position.utf16Be -= consumed;
+    }
+    emit finished();
+}
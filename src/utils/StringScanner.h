@@ -0,0 +1,132 @@
+#ifndef STRINGSCANNER_H
+#define STRINGSCANNER_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QList>
+
+#include <vector>
+
+#include "Cutter.h"
+
+/*!
+ * \brief Finds the strings in the mapped sections of the binary, like izz
+ *
+ * Sections are read through the core's I/O layer in large blocks and scanned
+ * on a thread pool, one task per range of overlapping sections. Printable
+ * ASCII, UTF-8 and ASCII range UTF-16LE/BE runs of at least minLength
+ * characters are reported. Blocks without any text are skipped 16 bytes at
+ * a time with SSE2 where available.
+ */
+class StringScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Encoding {
+        Ascii,
+        Utf8,
+        Utf16Le,
+        Utf16Be,
+    };
+
+    // A string found in a buffer, offset and size are in bytes
+    struct Match {
+        size_t offset;
+        size_t size;
+        int length;
+        Encoding encoding;
+    };
+
+    // Where scanning a buffer continues for each kind of string, in bytes
+    struct Position {
+        size_t utf8 = 0;
+        size_t utf16Le = 0;
+        size_t utf16Be = 0;
+
+        size_t min() const
+        {
+            return qMin(utf8, qMin(utf16Le, utf16Be));
+        }
+    };
+
+    // Same names as the type field of izzj
+    static QString encodingName(Encoding encoding);
+
+    /*!
+     * \brief Scans one buffer for strings, appending them to matches sorted by offset
+     *
+     * Scanning starts at position. Unless final is set, strings touching the end of the
+     * buffer are not reported yet and position is moved to where scanning has to
+     * continue once more data is appended to the buffer.
+     */
+    static void scan(const ut8 *data, size_t size, int minLength, bool final,
+                     Position &position, std::vector<Match> &matches);
+
+    explicit StringScanner(QObject *parent = nullptr);
+    ~StringScanner();
+
+    // Strings come in through stringsFound() in address order per section
+    void start(const QList<SectionDescription> &sections, int minLength);
+    bool isRunning() const
+    {
+        return running;
+    }
+
+    // bin.minstr, or the default of r2 if it is not set
+    static int defaultMinLength();
+    // The sections of the binary, or the whole file if it has none
+    static QList<SectionDescription> defaultSections();
+
+public slots:
+    // Tasks stop after their current block, finished() follows
+    void cancel();
+
+signals:
+    void stringsFound(const QList<StringDescription> &strings);
+    void finished();
+
+private slots:
+    void taskFinished();
+
+private:
+    QThreadPool pool;
+    QAtomicInt cancelled;
+    bool running = false;
+    int pending = 0;
+};
+
+/*!
+ * \brief Scans one range of the address space, run by StringScanner
+ */
+class StringScanTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    // sections all lie within [from, to)
+    StringScanTask(RVA from, RVA to, const QList<SectionDescription> &sections, int minLength,
+                   const QAtomicInt *cancelled);
+
+    void run() override;
+
+signals:
+    void stringsFound(const QList<StringDescription> &strings);
+    void finished();
+
+private:
+    // Read from the I/O layer at once, the core is only locked while reading
+    static const size_t BLOCK_SIZE = 4 * 1024 * 1024;
+
+    RVA from;
+    RVA to;
+    QList<SectionDescription> sections;
+    int minLength;
+    const QAtomicInt *cancelled;
+
+    QString sectionName(RVA addr) const;
+};
+
+#endif // STRINGSCANNER_H
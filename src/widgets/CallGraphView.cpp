@@ -0,0 +1,178 @@
+#include "CallGraphView.h"
+
+#include <QFontMetrics>
+#include <QToolTip>
+
+#include "utils/Configuration.h"
+
+CallGraphView::CallGraphView(QWidget *parent)
+    : GraphView(parent)
+{
+    // Callers are not reachable from the focused function, so no spanning tree here
+    layoutType = GraphLayout::LayoutType::Layered;
+
+    connect(Config(), SIGNAL(colorsUpdated()), this, SLOT(colorsUpdatedSlot()));
+    connect(Config(), SIGNAL(fontsUpdated()), this, SLOT(fontsUpdatedSlot()));
+
+    initFont();
+    colorsUpdatedSlot();
+}
+
+void CallGraphView::setCallGraph(const CallGraph *graph)
+{
+    this->graph = graph;
+}
+
+void CallGraphView::showFunctions(const std::vector<int> &functions, int focus)
+{
+    this->focus = focus;
+    shownFunctions = functions;
+    blocks.clear();
+    blockFunctions.clear();
+    if (!graph || functions.empty()) {
+        viewport()->update();
+        return;
+    }
+
+    for (int index : functions) {
+        blockFunctions[graph->function(index).offset] = index;
+    }
+
+    QFontMetrics metrics(font());
+    for (int index : functions) {
+        GraphBlock gb;
+        gb.entry = graph->function(index).offset;
+        for (int callee : graph->callees(index)) {
+            ut64 offset = graph->function(callee).offset;
+            if (callee != index && blockFunctions.count(offset)) {
+                gb.exits.push_back(offset);
+            }
+        }
+        gb.width = metrics.width(blockText(index)) + 2 * block_padding;
+        gb.height = charHeight + block_padding;
+        addBlock(gb);
+    }
+
+    ut64 entry = graph->function(focus >= 0 ? focus : functions.front()).offset;
+    setEntry(entry);
+    computeGraph(entry);
+    showBlock(blocks[entry]);
+    viewport()->update();
+}
+
+bool CallGraphView::isFunctionShown(int index) const
+{
+    return graph && blockFunctions.count(graph->function(index).offset);
+}
+
+QString CallGraphView::blockText(int index) const
+{
+    QString name = graph->function(index).name;
+    if (name.length() > MAX_NAME_LENGTH) {
+        name = name.left(MAX_NAME_LENGTH - 3) + "...";
+    }
+    return name;
+}
+
+void CallGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
+{
+    auto it = blockFunctions.find(block.entry);
+    if (!graph || it == blockFunctions.end()) {
+        return;
+    }
+
+    p.setPen(borderColor);
+    p.setBrush(it->second == focus ? focusColor : blockColor);
+    p.drawRect(block.x, block.y, block.width, block.height);
+
+    if (detailLevel() >= DetailLevel::Outline) {
+        return;
+    }
+    p.setPen(nameColor);
+    p.drawText(QRectF(block.x, block.y, block.width, block.height), Qt::AlignCenter,
+               blockText(it->second));
+}
+
+void CallGraphView::blockClicked(GraphView::GraphBlock &block, QMouseEvent *event, QPoint pos)
+{
+    Q_UNUSED(event);
+    Q_UNUSED(pos);
+    Core()->seek(block.entry);
+}
+
+void CallGraphView::blockDoubleClicked(GraphView::GraphBlock &block, QMouseEvent *event,
+                                       QPoint pos)
+{
+    Q_UNUSED(event);
+    Q_UNUSED(pos);
+    auto it = blockFunctions.find(block.entry);
+    if (it != blockFunctions.end()) {
+        emit functionActivated(it->second);
+    }
+}
+
+bool CallGraphView::helpEvent(QHelpEvent *event)
+{
+    if (!GraphView::helpEvent(event)) {
+        QToolTip::hideText();
+        event->ignore();
+    }
+
+    return true;
+}
+
+void CallGraphView::blockHelpEvent(GraphView::GraphBlock &block, QHelpEvent *event, QPoint pos)
+{
+    Q_UNUSED(pos);
+    auto it = blockFunctions.find(block.entry);
+    if (!graph || it == blockFunctions.end()) {
+        QToolTip::hideText();
+        event->ignore();
+        return;
+    }
+
+    int index = it->second;
+    QToolTip::showText(event->globalPos(),
+                       tr("%1 @ %2\nCallers: %3\nCallees: %4")
+                       .arg(graph->function(index).name)
+                       .arg(RAddressString(graph->function(index).offset))
+                       .arg(graph->callers(index).size())
+                       .arg(graph->callees(index).size()));
+}
+
+GraphView::EdgeConfiguration CallGraphView::edgeConfiguration(GraphView::GraphBlock &from,
+                                                              GraphView::GraphBlock *to)
+{
+    Q_UNUSED(from);
+    Q_UNUSED(to);
+    EdgeConfiguration ec;
+    ec.color = callColor;
+    ec.start_arrow = false;
+    ec.end_arrow = true;
+    return ec;
+}
+
+void CallGraphView::initFont()
+{
+    setFont(Config()->getFont());
+    charHeight = QFontMetrics(font()).height();
+    glyph_height = charHeight;
+}
+
+void CallGraphView::colorsUpdatedSlot()
+{
+    backgroundColor = ConfigColor("gui.background");
+    blockColor = ConfigColor("gui.alt_background");
+    minimapBlockColor = blockColor;
+    focusColor = ConfigColor("highlight");
+    borderColor = ConfigColor("gui.border");
+    nameColor = ConfigColor("fname");
+    callColor = ConfigColor("graph.trufae");
+    showFunctions(shownFunctions, focus);
+}
+
+void CallGraphView::fontsUpdatedSlot()
+{
+    initFont();
+    showFunctions(shownFunctions, focus);
+}
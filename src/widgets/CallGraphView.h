@@ -0,0 +1,63 @@
+#ifndef CALLGRAPHVIEW_H
+#define CALLGRAPHVIEW_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "widgets/GraphView.h"
+#include "utils/CallGraph.h"
+
+/*!
+ * \brief Shows a part of a CallGraph, one block per function
+ */
+class CallGraphView : public GraphView
+{
+    Q_OBJECT
+
+public:
+    explicit CallGraphView(QWidget *parent);
+
+    void setCallGraph(const CallGraph *graph);
+    // Shows the given functions of the call graph with the calls between them
+    void showFunctions(const std::vector<int> &functions, int focus);
+    bool isFunctionShown(int index) const;
+
+    void drawBlock(QPainter &p, GraphView::GraphBlock &block) override;
+    void blockClicked(GraphView::GraphBlock &block, QMouseEvent *event, QPoint pos) override;
+    void blockDoubleClicked(GraphView::GraphBlock &block, QMouseEvent *event,
+                            QPoint pos) override;
+    bool helpEvent(QHelpEvent *event) override;
+    void blockHelpEvent(GraphView::GraphBlock &block, QHelpEvent *event, QPoint pos) override;
+    GraphView::EdgeConfiguration edgeConfiguration(GraphView::GraphBlock &from,
+                                                   GraphView::GraphBlock *to) override;
+
+signals:
+    // A function was double clicked to become the new center of the graph
+    void functionActivated(int index);
+
+public slots:
+    void colorsUpdatedSlot();
+    void fontsUpdatedSlot();
+
+private:
+    static const int MAX_NAME_LENGTH = 40;
+
+    const CallGraph *graph = nullptr;
+    // Function index of each block, blocks are identified by function offsets
+    std::unordered_map<ut64, int> blockFunctions;
+    std::vector<int> shownFunctions;
+    int focus = -1;
+
+    int charHeight;
+
+    QColor blockColor;
+    QColor focusColor;
+    QColor borderColor;
+    QColor nameColor;
+    QColor callColor;
+
+    QString blockText(int index) const;
+    void initFont();
+};
+
+#endif // CALLGRAPHVIEW_H
@@ -0,0 +1,204 @@
+#include "CallGraphWidget.h"
+#include "CallGraphView.h"
+#include "MainWindow.h"
+
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+CallGraphWidget::CallGraphWidget(MainWindow *main, QAction *action) :
+    CutterDockWidget(main, action)
+{
+    setObjectName("CallGraph");
+    setWindowTitle(tr("Call Graph"));
+    setAllowedAreas(Qt::AllDockWidgetAreas);
+
+    directionCombo = new QComboBox();
+    directionCombo->addItem(tr("Callees"), int(CallGraph::Direction::Callees));
+    directionCombo->addItem(tr("Callers"), int(CallGraph::Direction::Callers));
+    directionCombo->addItem(tr("Both"), int(CallGraph::Direction::Both));
+
+    depthSpinBox = new QSpinBox();
+    depthSpinBox->setRange(1, 10);
+    depthSpinBox->setValue(2);
+
+    pathEdit = new QLineEdit();
+    pathEdit->setPlaceholderText(tr("Path to function..."));
+
+    statusLabel = new QLabel();
+
+    QHBoxLayout *toolLayout = new QHBoxLayout();
+    toolLayout->addWidget(new QLabel(tr("Show:")));
+    toolLayout->addWidget(directionCombo);
+    toolLayout->addWidget(new QLabel(tr("Depth:")));
+    toolLayout->addWidget(depthSpinBox);
+    toolLayout->addWidget(pathEdit);
+    toolLayout->addWidget(statusLabel, 1);
+
+    graphView = new CallGraphView(this);
+    graphView->setCallGraph(&graph);
+
+    QWidget *content = new QWidget();
+    QVBoxLayout *layout = new QVBoxLayout(content);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(toolLayout);
+    layout->addWidget(graphView);
+    setWidget(content);
+
+    graphPool.setMaxThreadCount(1);
+
+    connect(Core(), SIGNAL(seekChanged(RVA)), this, SLOT(onSeekChanged(RVA)));
+    connect(Core(), SIGNAL(refreshAll()), this, SLOT(invalidateGraph()));
+    connect(Core(), SIGNAL(functionsChanged()), this, SLOT(invalidateGraph()));
+    connect(Core(), SIGNAL(functionRenamed(const QString &, const QString &)), this,
+            SLOT(invalidateGraph()));
+
+    connect(directionCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(updateView()));
+    connect(depthSpinBox, SIGNAL(valueChanged(int)), this, SLOT(updateView()));
+    connect(pathEdit, SIGNAL(returnPressed()), this, SLOT(findPath()));
+    connect(graphView, SIGNAL(functionActivated(int)), this, SLOT(showFunction(int)));
+
+    connect(this, &QDockWidget::visibilityChanged, this, [this](bool visibility) {
+        if (visibility) {
+            updateView();
+        }
+    });
+}
+
+CallGraphWidget::~CallGraphWidget()
+{
+    graphPool.clear();
+    graphPool.waitForDone();
+}
+
+bool CallGraphWidget::ensureGraph()
+{
+    if (!graphDirty) {
+        return true;
+    }
+    if (buildingGeneration == graphGeneration) {
+        return false;
+    }
+
+    buildingGeneration = graphGeneration;
+    std::shared_ptr<CallGraph> result = std::make_shared<CallGraph>();
+    CallGraphTask *task = new CallGraphTask(result);
+    int generation = graphGeneration;
+    connect(task, &CallGraphTask::finished, this, [this, result, generation]() {
+        // Outdated, invalidateGraph() already asked for a new one
+        if (generation != graphGeneration) {
+            return;
+        }
+        // The view refers to functions by their index in the old graph
+        graphView->showFunctions(std::vector<int>(), -1);
+        graph = std::move(*result);
+        graphDirty = false;
+        updateView();
+    });
+    graphPool.clear();
+    graphPool.start(task);
+    return false;
+}
+
+int CallGraphWidget::focusIndex()
+{
+    if (focusOffset == RVA_INVALID) {
+        focusOffset = Core()->getOffset();
+    }
+    return graph.indexOf(focusOffset);
+}
+
+void CallGraphWidget::onSeekChanged(RVA addr)
+{
+    // Nothing is loaded while the dock is hidden
+    if (!isVisible()) {
+        focusOffset = addr;
+        return;
+    }
+    // Shown once the graph is built
+    if (!ensureGraph()) {
+        focusOffset = addr;
+        return;
+    }
+    // Moving between the functions already shown, e.g. by clicking them, keeps the graph
+    int index = graph.indexOf(addr);
+    if (index < 0 || graphView->isFunctionShown(index)) {
+        return;
+    }
+    focusOffset = addr;
+    updateView();
+}
+
+void CallGraphWidget::invalidateGraph()
+{
+    graphDirty = true;
+    graphGeneration++;
+    if (isVisible()) {
+        updateView();
+    }
+}
+
+void CallGraphWidget::updateView()
+{
+    if (!isVisible()) {
+        return;
+    }
+    if (!ensureGraph()) {
+        statusLabel->setText(tr("Loading call graph..."));
+        return;
+    }
+
+    int index = focusIndex();
+    if (index < 0) {
+        graphView->showFunctions(std::vector<int>(), -1);
+        statusLabel->setText(tr("No function at the current offset"));
+        return;
+    }
+
+    auto direction = CallGraph::Direction(directionCombo->currentData().toInt());
+    std::vector<int> functions = graph.neighbourhood(index, depthSpinBox->value(), direction,
+                                                     MAX_FUNCTIONS);
+    if (int(functions.size()) >= MAX_FUNCTIONS) {
+        statusLabel->setText(tr("Showing the %1 closest functions").arg(MAX_FUNCTIONS));
+    } else {
+        statusLabel->setText(tr("%1 of %2 functions").arg(functions.size()).arg(graph.count()));
+    }
+    graphView->showFunctions(functions, index);
+}
+
+void CallGraphWidget::showFunction(int index)
+{
+    focusOffset = graph.function(index).offset;
+    updateView();
+}
+
+void CallGraphWidget::findPath()
+{
+    if (pathEdit->text().isEmpty()) {
+        updateView();
+        return;
+    }
+    if (!ensureGraph()) {
+        statusLabel->setText(tr("Loading call graph..."));
+        return;
+    }
+
+    int from = focusIndex();
+    int to = graph.indexOf(Core()->math(pathEdit->text()));
+    if (from < 0 || to < 0) {
+        statusLabel->setText(tr("Unknown function"));
+        return;
+    }
+
+    std::vector<int> path = graph.path(from, to);
+    if (path.empty()) {
+        statusLabel->setText(tr("%1 can not reach %2").arg(graph.function(from).name,
+                                                            graph.function(to).name));
+        return;
+    }
+    statusLabel->setText(tr("Path of %1 calls").arg(path.size() - 1));
+    graphView->showFunctions(path, from);
+}
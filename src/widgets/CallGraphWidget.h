@@ -0,0 +1,59 @@
+#ifndef CALLGRAPHWIDGET_H
+#define CALLGRAPHWIDGET_H
+
+#include <QThreadPool>
+
+#include "CutterDockWidget.h"
+#include "utils/CallGraph.h"
+
+class MainWindow;
+class CallGraphView;
+class QComboBox;
+class QSpinBox;
+class QLineEdit;
+class QLabel;
+
+/*!
+ * \brief Call graph of the whole binary around the function at the current seek
+ *
+ * The call graph is only built once the dock is shown, on a worker thread, and
+ * only the functions a few calls away from the current one are laid out.
+ */
+class CallGraphWidget : public CutterDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CallGraphWidget(MainWindow *main, QAction *action = nullptr);
+    ~CallGraphWidget();
+
+private slots:
+    void onSeekChanged(RVA addr);
+    void invalidateGraph();
+    void updateView();
+    void showFunction(int index);
+    void findPath();
+
+private:
+    static const int MAX_FUNCTIONS = 300;
+
+    CallGraph graph;
+    bool graphDirty = true;
+    // Bumped whenever the functions change, a build started before is thrown away
+    int graphGeneration = 0;
+    int buildingGeneration = -1;
+    QThreadPool graphPool;
+    RVA focusOffset = RVA_INVALID;
+
+    CallGraphView *graphView;
+    QComboBox *directionCombo;
+    QSpinBox *depthSpinBox;
+    QLineEdit *pathEdit;
+    QLabel *statusLabel;
+
+    // Starts building the graph if it is out of date, returns whether it is up to date
+    bool ensureGraph();
+    int focusIndex();
+};
+
+#endif // CALLGRAPHWIDGET_H
@@ -7,9 +7,11 @@
 #include <QPropertyAnimation>
 #include <QShortcut>
 #include <QToolTip>
-#include <QTextDocument>
 #include <QFileDialog>
 #include <QFile>
+#include <QtMath>
+
+#include <algorithm>
 
 #include "Cutter.h"
 #include "utils/Colors.h"
@@ -23,6 +25,7 @@ DisassemblerGraphView::DisassemblerGraphView(QWidget *parent)
       mMenu(new DisassemblyContextMenu(this))
 {
     highlight_token = nullptr;
+    blockCache.setMaxCost(BLOCK_CACHE_MAX_KB);
     // Signals that require a refresh all
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshView()));
     connect(Core(), SIGNAL(commentsChanged()), this, SLOT(refreshView()));
@@ -150,6 +153,8 @@ void DisassemblerGraphView::loadCurrentGraph()
     RVA entry = func["offset"].toVariant().toULongLong();
 
     setEntry(entry);
+    int blockLength = Config()->getGraphBlockMaxChars() + Core()->getConfigb("asm.bytes") * 24 +
+                      Core()->getConfigb("asm.emu") * 10;
     for (QJsonValueRef blockRef : func["blocks"].toArray()) {
         QJsonObject block = blockRef.toObject();
         RVA block_entry = block["offset"].toVariant().toULongLong();
@@ -191,18 +196,9 @@ void DisassemblerGraphView::loadCurrentGraph()
             // Skip last byte, otherwise it will overlap with next instruction
             i.size -= 1;
 
-            QString disas;
-            disas = op["text"].toString();
-
-            QTextDocument textDoc;
-            textDoc.setHtml(disas);
-
-            RichTextPainter::List richText = RichTextPainter::fromTextDocument(textDoc);
-            //Colors::colorizeAssembly(richText, textDoc.toPlainText(), 0);
+            RichTextPainter::List richText = RichTextPainter::fromHtml(op["text"].toString());
 
             bool cropped;
-            int blockLength = Config()->getGraphBlockMaxChars() + Core()->getConfigb("asm.bytes") * 24 +
-                              Core()->getConfigb("asm.emu") * 10;
             i.text = Text(RichTextPainter::cropped(richText, blockLength, "...", &cropped));
             if (cropped)
                 i.fullText = richText;
@@ -210,6 +206,14 @@ void DisassemblerGraphView::loadCurrentGraph()
                 i.fullText = Text();
             db.instrs.push_back(i);
         }
+        int line = 0;
+        db.instr_lines.reserve(db.instrs.size() + 1);
+        for (const Instr &instr : db.instrs) {
+            db.instr_lines.push_back(line);
+            line += int(instr.text.lines.size());
+        }
+        db.instr_lines.push_back(line);
+        db.content_hash = contentHash(db);
         disassembly_blocks[db.entry] = db;
         prepareGraphNode(gb);
         f.blocks.push_back(db);
@@ -221,7 +225,13 @@ void DisassemblerGraphView::loadCurrentGraph()
     anal.status = "Ready.";
     anal.entry = f.entry;
 
+    buildAddressIndex();
+    updateSelection(Core()->getOffset());
+
     if (func["blocks"].toArray().size() > 0) {
+        layoutType = Config()->getGraphLayered() ? GraphLayout::LayoutType::Layered
+                     : GraphLayout::LayoutType::Medium;
+        setMinimapVisible(Config()->getGraphMinimap());
         computeGraph(entry);
         viewport()->update();
 
@@ -269,31 +279,117 @@ void DisassemblerGraphView::initFont()
     charWidth = metrics.width('X');
     charHeight = metrics.height();
     charOffset = 0;
+    glyph_height = charHeight;
     if (mFontMetrics)
         delete mFontMetrics;
     mFontMetrics = new CachedFontMetrics(this, font());
 }
 
-void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
+// The mnemonic is the first part of an instruction line that is not its address
+static const RichTextPainter::CustomRichText_t *findMnemonic(const RichTextPainter::List &line)
 {
-    p.setPen(Qt::black);
-    p.setBrush(Qt::gray);
-    p.drawRect(block.x, block.y, block.width, block.height);
+    for (const RichTextPainter::CustomRichText_t &part : line) {
+        QString text = part.text.trimmed();
+        if (!text.isEmpty() && !text.startsWith("0x")) {
+            return &part;
+        }
+    }
+    return nullptr;
+}
 
+uint DisassemblerGraphView::contentHash(const DisassemblyBlock &db)
+{
+    uint hash = uint(db.terminal) | (uint(db.indirectcall) << 1);
+    auto addText = [&hash](const Text & text) {
+        for (auto &line : text.lines) {
+            for (auto &part : line) {
+                hash = hash * 31 + qHash(part.text);
+                hash = hash * 31 + part.textColor.rgba();
+                hash = hash * 31 + part.textBackground.rgba();
+            }
+            hash = hash * 31 + 1;
+        }
+    };
+    addText(db.header_text);
+    for (const Instr &instr : db.instrs) {
+        addText(instr.text);
+    }
+    return hash;
+}
 
+const QPixmap *DisassemblerGraphView::cachedBlockPixmap(GraphBlock &block, DisassemblyBlock &db,
+                                                         DetailLevel lod)
+{
+    qreal scale = qCeil(current_scale * BLOCK_CACHE_ZOOM_STEPS) / qreal(BLOCK_CACHE_ZOOM_STEPS);
+    CachedBlock *cached = blockCache.object(block.entry);
+    if (cached && cached->scale == scale && cached->lod == lod
+            && cached->content_hash == db.content_hash
+            && cached->width == block.width && cached->height == block.height) {
+        return &cached->pixmap;
+    }
+
+    qreal ratio = devicePixelRatioF();
+    QSize pixels(qCeil((block.width + BLOCK_CACHE_MARGIN) * scale * ratio),
+                 qCeil((block.height + BLOCK_CACHE_MARGIN) * scale * ratio));
+    int cost = pixels.width() * pixels.height() * 4 / 1024 + 1;
+    if (cost > blockCache.maxCost()) {
+        return nullptr;
+    }
+
+    cached = new CachedBlock;
+    cached->scale = scale;
+    cached->lod = lod;
+    cached->content_hash = db.content_hash;
+    cached->width = block.width;
+    cached->height = block.height;
+    cached->pixmap = QPixmap(pixels);
+    cached->pixmap.setDevicePixelRatio(ratio);
+    cached->pixmap.fill(Qt::transparent);
+
+    QPainter painter(&cached->pixmap);
+    painter.setFont(font());
+    painter.scale(scale, scale);
+    painter.translate(-block.x, -block.y);
+    paintBlock(painter, block, db, false, -1, lod);
+    painter.end();
+
+    blockCache.insert(block.entry, cached, cost);
+    return &cached->pixmap;
+}
+
+void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
+{
     // Render node
     DisassemblyBlock &db = disassembly_blocks[block.entry];
-    bool block_selected = false;
-    RVA selected_instruction = RVA_INVALID;
-
-    // Figure out if the current block is selected
-    for (const Instr &instr : db.instrs) {
-        RVA addr = Core()->getOffset();
-        if ((instr.addr <= addr) && (addr <= instr.addr + instr.size)) {
-            block_selected = true;
-            selected_instruction = instr.addr;
+    bool block_selected = block.entry == selected_block;
+
+    // The selected block changes with every seek, it is painted directly instead
+    DetailLevel lod = detailLevel();
+    if (!block_selected && (lod == DetailLevel::Full || lod == DetailLevel::Mnemonic)) {
+        const QPixmap *pixmap = cachedBlockPixmap(block, db, lod);
+        if (pixmap) {
+            p.drawPixmap(QRectF(block.x, block.y, block.width + BLOCK_CACHE_MARGIN,
+                                block.height + BLOCK_CACHE_MARGIN), *pixmap, QRectF(pixmap->rect()));
+            return;
         }
-        // TODO: L219
+    }
+
+    paintBlock(p, block, db, block_selected, block_selected ? selected_instr : -1, lod);
+}
+
+void DisassemblerGraphView::paintBlock(QPainter &p, GraphBlock &block, DisassemblyBlock &db,
+                                       bool block_selected, int selected_index, DetailLevel lod)
+{
+    p.setPen(Qt::black);
+    p.setBrush(Qt::gray);
+    p.drawRect(block.x, block.y, block.width, block.height);
+
+    if (lod == DetailLevel::Shape) {
+        // Text would be smaller than a pixel, only draw the block itself
+        p.setPen(graphNodeColor);
+        p.setBrush(block_selected ? disassemblySelectedBackgroundColor : disassemblyBackgroundColor);
+        p.drawRect(block.x, block.y, block.width, block.height);
+        return;
     }
 
     p.setPen(QColor(0, 0, 0, 0));
@@ -318,38 +414,29 @@ void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
     p.drawRect(block.x, block.y,
                block.width, block.height);
 
-    // Draw different background for selected instruction
-    if (selected_instruction != RVA_INVALID) {
-        int y = block.y + (2 * charWidth) + (db.header_text.lines.size() * charHeight);
-        for (Instr &instr : db.instrs) {
-            auto selected = instr.addr == selected_instruction;
-            //auto traceCount = dbgfunctions->GetTraceRecordHitCount(instr.addr);
-            auto traceCount = 0;
-            if (selected && traceCount) {
-                p.fillRect(QRect(block.x + charWidth, y, block.width - (10 + 2 * charWidth),
-                                 int(instr.text.lines.size()) * charHeight), disassemblyTracedSelectionColor);
-            } else if (selected) {
-                p.fillRect(QRect(block.x + charWidth, y, block.width - (10 + 2 * charWidth),
-                                 int(instr.text.lines.size()) * charHeight), disassemblySelectionColor);
-            } else if (traceCount) {
-                // Color depending on how often a sequence of code is executed
-                int exponent = 1;
-                while (traceCount >>= 1) //log2(traceCount)
-                    exponent++;
-                int colorDiff = (exponent * exponent) / 2;
-
-                // If the user has a light trace background color, substract
-                if (disassemblyTracedColor.blue() > 160)
-                    colorDiff *= -1;
-
-                p.fillRect(QRect(block.x + charWidth, y, block.width - (10 + 2 * charWidth),
-                                 int(instr.text.lines.size()) * charHeight),
-                           QColor(disassemblyTracedColor.red(),
-                                  disassemblyTracedColor.green(),
-                                  std::max(0, std::min(256, disassemblyTracedColor.blue() + colorDiff))));
-            }
-            y += int(instr.text.lines.size()) * charHeight;
+    if (lod == DetailLevel::Outline) {
+        // Label the block with its address in a font which stays readable at this zoom
+        QFont labelFont = font();
+        if (labelFont.pointSizeF() > 0) {
+            labelFont.setPointSizeF(labelFont.pointSizeF() / current_scale);
+        } else {
+            labelFont.setPixelSize(int(labelFont.pixelSize() / current_scale));
         }
+        p.setFont(labelFont);
+        p.setPen(mAddressColor);
+        p.drawText(QRectF(block.x, block.y, block.width, block.height), Qt::AlignCenter,
+                   RAddressString(db.entry));
+        p.setFont(font());
+        return;
+    }
+
+    // Draw different background for selected instruction
+    if (selected_index >= 0) {
+        int line = int(db.header_text.lines.size()) + db.instr_lines[selected_index];
+        int lines = db.instr_lines[selected_index + 1] - db.instr_lines[selected_index];
+        int y = block.y + (2 * charWidth) + (line * charHeight);
+        p.fillRect(QRect(block.x + charWidth, y, block.width - (10 + 2 * charWidth),
+                         lines * charHeight), disassemblySelectionColor);
     }
 
 
@@ -371,8 +458,18 @@ void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block)
 
             // TODO: Breakpoint/Cip stuff
 
-            RichTextPainter::paintRichText(&p, x + charWidth, y, block.width - charWidth, charHeight, 0, line,
-                                           mFontMetrics);
+            if (lod == DetailLevel::Mnemonic) {
+                const RichTextPainter::CustomRichText_t *mnemonic = findMnemonic(line);
+                if (mnemonic) {
+                    p.setPen(mnemonic->textColor);
+                    p.drawText(QRect(x + charWidth, y, block.width - charWidth, charHeight),
+                               Qt::TextBypassShaping,
+                               mnemonic->text.section(' ', 0, 0, QString::SectionSkipEmpty));
+                }
+            } else {
+                RichTextPainter::paintRichText(&p, x + charWidth, y, block.width - charWidth, charHeight, 0, line,
+                                               mFontMetrics);
+            }
             y += charHeight;
 
         }
@@ -431,16 +528,14 @@ DisassemblerGraphView::Instr *DisassemblerGraphView::getInstrForMouseEvent(
     int text_point_y = point->y() - off_y;
     int mouse_row = text_point_y / charHeight;
 
-    int cur_row = db.header_text.lines.size();
-
-    for (Instr &instr : db.instrs) {
-        if (mouse_row < cur_row + (int)instr.text.lines.size()) {
-            return &instr;
-        }
-        cur_row += instr.text.lines.size();
+    // Rows above the first instruction belong to it
+    int row = std::max(0, mouse_row - int(db.header_text.lines.size()));
+    auto it = std::upper_bound(db.instr_lines.begin(), db.instr_lines.end(), row);
+    size_t index = size_t(it - db.instr_lines.begin()) - 1;
+    if (index >= db.instrs.size()) {
+        return nullptr;
     }
-
-    return nullptr;
+    return &db.instrs[index];
 }
 
 // Public Slots
@@ -448,6 +543,7 @@ DisassemblerGraphView::Instr *DisassemblerGraphView::getInstrForMouseEvent(
 void DisassemblerGraphView::colorsUpdatedSlot()
 {
     disassemblyBackgroundColor = ConfigColor("gui.alt_background");
+    minimapBlockColor = disassemblyBackgroundColor;
     disassemblySelectedBackgroundColor = ConfigColor("gui.background");
     mDisabledBreakpointColor = disassemblyBackgroundColor;
     graphNodeColor = ConfigColor("gui.border");
@@ -459,22 +555,57 @@ void DisassemblerGraphView::colorsUpdatedSlot()
     brfalseColor = ConfigColor("graph.false");
 
     mCommentColor = ConfigColor("comment");
+    mAddressColor = ConfigColor("offset");
+    blockCache.clear();
     initFont();
     refreshView();
 }
 
 void DisassemblerGraphView::fontsUpdatedSlot()
 {
+    blockCache.clear();
     initFont();
     refreshView();
 }
 
-DisassemblerGraphView::DisassemblyBlock *DisassemblerGraphView::blockForAddress(RVA addr)
+void DisassemblerGraphView::buildAddressIndex()
 {
+    address_index.clear();
+    address_index.reserve(disassembly_blocks.size());
     for (auto &blockIt : disassembly_blocks) {
-        DisassemblyBlock &db = blockIt.second;
-        for (Instr i : db.instrs) {
-            if ((i.addr <= addr) && (addr <= i.addr + i.size)) {
+        const DisassemblyBlock &db = blockIt.second;
+        if (db.instrs.empty()) {
+            continue;
+        }
+        const Instr &last = db.instrs.back();
+        address_index.push_back({ db.instrs.front().addr, last.addr + last.size, 0, db.entry });
+    }
+    std::sort(address_index.begin(), address_index.end(),
+    [](const AddressRange & a, const AddressRange & b) {
+        return a.start < b.start;
+    });
+    RVA max_end = 0;
+    for (AddressRange &range : address_index) {
+        max_end = std::max(max_end, range.end);
+        range.max_end = max_end;
+    }
+}
+
+DisassemblerGraphView::DisassemblyBlock *DisassemblerGraphView::blockForAddress(RVA addr)
+{
+    auto it = std::upper_bound(address_index.begin(), address_index.end(), addr,
+    [](RVA value, const AddressRange & range) {
+        return value < range.start;
+    });
+    // Blocks may overlap, walk back as long as an earlier block could still contain addr
+    while (it != address_index.begin()) {
+        --it;
+        if (it->max_end < addr) {
+            break;
+        }
+        if (addr <= it->end) {
+            DisassemblyBlock &db = disassembly_blocks[it->block];
+            if (instrIndexForAddress(db, addr) >= 0) {
                 return &db;
             }
         }
@@ -482,9 +613,51 @@ DisassemblerGraphView::DisassemblyBlock *DisassemblerGraphView::blockForAddress(
     return nullptr;
 }
 
+int DisassemblerGraphView::instrIndexForAddress(const DisassemblyBlock &db, RVA addr)
+{
+    // Instructions are sorted, find the last one starting at or before addr
+    auto it = std::upper_bound(db.instrs.begin(), db.instrs.end(), addr,
+    [](RVA value, const Instr & instr) {
+        return value < instr.addr;
+    });
+    if (it == db.instrs.begin()) {
+        return -1;
+    }
+    --it;
+    if (addr > it->addr + it->size) {
+        return -1;
+    }
+    return int(it - db.instrs.begin());
+}
+
+void DisassemblerGraphView::updateSelection(RVA addr)
+{
+    invalidateBlockTiles(selected_block);
+    selected_block = RVA_INVALID;
+    selected_instr = -1;
+    DisassemblyBlock *db = blockForAddress(addr);
+    if (db) {
+        selected_block = db->entry;
+        selected_instr = instrIndexForAddress(*db, addr);
+    }
+    invalidateBlockTiles(selected_block);
+}
+
+// The selection is part of the rendered tiles
+void DisassemblerGraphView::invalidateBlockTiles(ut64 entry)
+{
+    auto it = blocks.find(entry);
+    if (it != blocks.end()) {
+        const GraphBlock &block = it->second;
+        invalidateTiles(QRectF(block.x, block.y, block.width, block.height));
+    }
+}
+
 void DisassemblerGraphView::onSeekChanged(RVA addr)
 {
     mMenu->setOffset(addr);
+    updateSelection(addr);
+    viewport()->update();
     // If this seek was NOT done by us...
     if (!sent_seek) {
         DisassemblyBlock *db = blockForAddress(addr);
@@ -518,7 +691,7 @@ void DisassemblerGraphView::zoomIn()
 void DisassemblerGraphView::zoomOut()
 {
     current_scale -= 0.1;
-    current_scale = std::max(current_scale, 0.3);
+    current_scale = std::max(current_scale, 0.1);
     auto areaSize = viewport()->size();
     adjustSize(areaSize.width(), areaSize.height());
     viewport()->update();
@@ -534,44 +707,46 @@ void DisassemblerGraphView::zoomReset()
 
 void DisassemblerGraphView::takeTrue()
 {
-    DisassemblyBlock *db = blockForAddress(Core()->getOffset());
-    if (db->true_path != RVA_INVALID) {
-        Core()->seek(db->true_path);
-    } else if (blocks[db->entry].exits.size()) {
-        Core()->seek(blocks[db->entry].exits[0]);
+    auto it = disassembly_blocks.find(selected_block);
+    if (it == disassembly_blocks.end()) {
+        return;
+    }
+    DisassemblyBlock &db = it->second;
+    if (db.true_path != RVA_INVALID) {
+        Core()->seek(db.true_path);
+    } else if (blocks[db.entry].exits.size()) {
+        Core()->seek(blocks[db.entry].exits[0]);
     }
 }
 
 void DisassemblerGraphView::takeFalse()
 {
-    DisassemblyBlock *db = blockForAddress(Core()->getOffset());
-    if (db->false_path != RVA_INVALID) {
-        Core()->seek(db->false_path);
-    } else if (blocks[db->entry].exits.size()) {
-        Core()->seek(blocks[db->entry].exits[0]);
+    auto it = disassembly_blocks.find(selected_block);
+    if (it == disassembly_blocks.end()) {
+        return;
+    }
+    DisassemblyBlock &db = it->second;
+    if (db.false_path != RVA_INVALID) {
+        Core()->seek(db.false_path);
+    } else if (blocks[db.entry].exits.size()) {
+        Core()->seek(blocks[db.entry].exits[0]);
     }
 }
 
 void DisassemblerGraphView::seekInstruction(bool previous_instr)
 {
-    RVA addr = Core()->getOffset();
-    DisassemblyBlock *db = blockForAddress(addr);
-    if (!db) {
+    auto it = disassembly_blocks.find(selected_block);
+    if (it == disassembly_blocks.end() || selected_instr < 0) {
         return;
     }
+    DisassemblyBlock &db = it->second;
 
-    for (size_t i = 0; i < db->instrs.size(); i++) {
-        Instr &instr = db->instrs[i];
-        if (!((instr.addr <= addr) && (addr <= instr.addr + instr.size))) {
-            continue;
-        }
-
-        // Found the instructon. Check if a next one exists
-        if (!previous_instr && (i < db->instrs.size() - 1)) {
-            seek(db->instrs[i + 1].addr, true);
-        } else if (previous_instr && (i > 0)) {
-            seek(db->instrs[i - 1].addr);
-        }
+    // Check if a next or previous instruction exists
+    size_t i = size_t(selected_instr);
+    if (!previous_instr && (i < db.instrs.size() - 1)) {
+        seek(db.instrs[i + 1].addr, true);
+    } else if (previous_instr && (i > 0)) {
+        seek(db.instrs[i - 1].addr);
     }
 }
 
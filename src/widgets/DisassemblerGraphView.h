@@ -6,6 +6,8 @@
 #include <QWidget>
 #include <QPainter>
 #include <QShortcut>
+#include <QCache>
+#include <QPixmap>
 
 #include "widgets/GraphView.h"
 #include "menus/DisassemblyContextMenu.h"
@@ -94,11 +96,15 @@ class DisassemblerGraphView : public GraphView
     struct DisassemblyBlock {
         Text header_text;
         std::vector<Instr> instrs;
+        // First line of each instruction below the header, followed by the total line count
+        std::vector<int> instr_lines;
         ut64 entry = 0;
         ut64 true_path = 0;
         ut64 false_path = 0;
         bool terminal = false;
         bool indirectcall = false;
+        // Identifies what the block looks like, see contentHash()
+        uint content_hash = 0;
     };
 
     struct Function {
@@ -169,6 +175,26 @@ private:
     bool transition_dont_seek = false;
     bool sent_seek = false;
 
+    // Block and instruction at the current seek, kept up to date by onSeekChanged()
+    // so painting does not have to ask the core
+    ut64 selected_block = RVA_INVALID;
+    int selected_instr = -1;
+    void updateSelection(RVA addr);
+    static int instrIndexForAddress(const DisassemblyBlock &db, RVA addr);
+    void invalidateBlockTiles(ut64 entry);
+
+    // Addresses covered by a block, see blockForAddress()
+    struct AddressRange {
+        RVA start;
+        RVA end;
+        // Largest end of this and all earlier ranges
+        RVA max_end;
+        ut64 block;
+    };
+    // Sorted by start, rebuilt with every graph
+    std::vector<AddressRange> address_index;
+    void buildAddressIndex();
+
     HighlightToken *highlight_token;
     // Font data
     CachedFontMetrics *mFontMetrics;
@@ -179,6 +205,26 @@ private:
 
     DisassemblyContextMenu *mMenu;
 
+    // Blocks rendered without any selection, so panning only has to blit them
+    struct CachedBlock {
+        QPixmap pixmap;
+        qreal scale;
+        DetailLevel lod;
+        uint content_hash;
+        int width;
+        int height;
+    };
+    // Rendering happens in zoom steps of 1 / BLOCK_CACHE_ZOOM_STEPS
+    static const int BLOCK_CACHE_ZOOM_STEPS = 20;
+    // Room for the shadow next to the block
+    static const int BLOCK_CACHE_MARGIN = 9;
+    static const int BLOCK_CACHE_MAX_KB = 64 * 1024;
+    QCache<ut64, CachedBlock> blockCache;
+    static uint contentHash(const DisassemblyBlock &db);
+    const QPixmap *cachedBlockPixmap(GraphBlock &block, DisassemblyBlock &db, DetailLevel lod);
+    void paintBlock(QPainter &p, GraphBlock &block, DisassemblyBlock &db, bool block_selected,
+                    int selected_index, DetailLevel lod);
+
     void initFont();
     void prepareGraphNode(GraphBlock &block);
     RVA getAddrForMouseEvent(GraphBlock &block, QPoint *point);
@@ -12,6 +12,7 @@
 #include <QVBoxLayout>
 #include <QRegularExpression>
 #include <QTextBlockUserData>
+#include <QTextBoundaryFinder>
 
 
 class DisassemblyTextBlockUserData: public QTextBlockUserData
@@ -185,6 +186,7 @@ void DisassemblyWidget::refreshDisasm(RVA offset)
     if (maxLines <= 0) {
         connectCursorPositionChanged(true);
         mDisasTextEdit->clear();
+        wordIndex.clear();
         connectCursorPositionChanged(false);
         return;
     }
@@ -230,6 +232,7 @@ void DisassemblyWidget::refreshDisasm(RVA offset)
     tc.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
     tc.removeSelectedText();
 
+    buildWordIndex();
     updateCursorPosition();
 
     mDisasTextEdit->setLockScroll(false);
@@ -296,25 +299,19 @@ void DisassemblyWidget::highlightCurrentLine()
     int lineEndPos = cursor.position();
 
     // Highlight all the words in the document same as the current one
-    QTextDocument *document = mDisasTextEdit->document();
-
-    QTextEdit::ExtraSelection highlightSelection;
-    highlightSelection.cursor = cursor;
-    highlightSelection.cursor.movePosition(QTextCursor::Start, QTextCursor::MoveAnchor);
-
-    while (!highlightSelection.cursor.isNull() && !highlightSelection.cursor.atEnd()) {
-        highlightSelection.cursor = document->find(searchString, highlightSelection.cursor,
-                                                   QTextDocument::FindWholeWords);
-
-        if (!highlightSelection.cursor.isNull()) {
-            if (highlightSelection.cursor.position() >= listStartPos
-                    && highlightSelection.cursor.position() <= lineEndPos) {
+    auto wordIt = wordIndex.constFind(searchString);
+    if (!searchString.isEmpty() && wordIt != wordIndex.constEnd()) {
+        QTextEdit::ExtraSelection highlightSelection;
+        highlightSelection.cursor = QTextCursor(mDisasTextEdit->document());
+        for (int pos : wordIt.value()) {
+            if (pos >= listStartPos && pos <= lineEndPos) {
                 highlightSelection.format.setBackground(highlightWordCurrentLineColor);
             } else {
                 highlightSelection.format.setBackground(highlightWordColor);
             }
 
-            highlightSelection.cursor.movePosition(QTextCursor::EndOfWord, QTextCursor::KeepAnchor);
+            highlightSelection.cursor.setPosition(pos);
+            highlightSelection.cursor.setPosition(pos + searchString.length(), QTextCursor::KeepAnchor);
             extraSelections.append(highlightSelection);
         }
     }
@@ -322,6 +319,26 @@ void DisassemblyWidget::highlightCurrentLine()
     mDisasTextEdit->setExtraSelections(extraSelections);
 }
 
+void DisassemblyWidget::buildWordIndex()
+{
+    wordIndex.clear();
+
+    // Split every line at the same word boundaries QTextCursor::WordUnderCursor uses,
+    // so a lookup with the selected word finds exactly the matching spans.
+    QTextDocument *document = mDisasTextEdit->document();
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+        const QString text = block.text();
+        QTextBoundaryFinder finder(QTextBoundaryFinder::Word, text);
+        int start = 0;
+        for (int end = finder.toNextBoundary(); end != -1; end = finder.toNextBoundary()) {
+            if (finder.boundaryReasons() & QTextBoundaryFinder::EndOfItem) {
+                wordIndex[text.mid(start, end - start)].append(block.position() + start);
+            }
+            start = end;
+        }
+    }
+}
+
 void DisassemblyWidget::showDisasContextMenu(const QPoint &pt)
 {
     mCtxMenu->exec(mDisasTextEdit->mapToGlobal(pt));
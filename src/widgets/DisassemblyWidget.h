@@ -6,6 +6,8 @@
 #include <QTextEdit>
 #include <QPlainTextEdit>
 #include <QShortcut>
+#include <QHash>
+#include <QVector>
 
 
 class DisassemblyTextEdit;
@@ -51,6 +53,13 @@ private:
     int cursorLineOffset;
     bool seekFromCursor;
 
+    /*!
+     * document positions of every word on the current page, keyed by the word.
+     * Rebuilt by refreshDisasm() so highlightCurrentLine() only needs a lookup.
+     */
+    QHash<QString, QVector<int>> wordIndex;
+    void buildWordIndex();
+
     RVA readCurrentDisassemblyOffset();
     RVA readDisassemblyOffset(QTextCursor tc);
     bool eventFilter(QObject *obj, QEvent *event);
@@ -5,7 +5,8 @@
 
 ExportsModel::ExportsModel(QList<ExportDescription> *exports, QObject *parent)
     : QAbstractListModel(parent),
-      exports(exports)
+      exports(exports),
+      table(NumberCount, StringCount)
 {
 }
 
@@ -75,6 +76,15 @@ void ExportsModel::beginReloadExports()
 
 void ExportsModel::endReloadExports()
 {
+    table.clear();
+    table.reserve(exports->count());
+    for (const ExportDescription &exp : *exports) {
+        int row = table.appendRow();
+        table.setNumber(OffsetNumber, row, exp.vaddr);
+        table.setNumber(SizeNumber, row, exp.size);
+        table.setString(NameString, row, exp.name);
+        table.setString(TypeString, row, exp.type);
+    }
     endResetModel();
 }
 
@@ -89,40 +99,41 @@ ExportsSortFilterProxyModel::ExportsSortFilterProxyModel(ExportsModel *source_mo
     setSourceModel(source_model);
 }
 
-bool ExportsSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
+bool ExportsSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &) const
 {
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    ExportDescription exp = index.data(ExportsModel::ExportDescriptionRole).value<ExportDescription>();
-    return exp.name.contains(filterRegExp());
+    const ColumnarTable &table = static_cast<ExportsModel *>(sourceModel())->getTable();
+    if (row >= table.rowCount())
+        return false;
+    return table.matches(ExportsModel::NameString, row, filterRegExp());
 }
 
 bool ExportsSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
-    ExportDescription left_exp = left.data(
-                                     ExportsModel::ExportDescriptionRole).value<ExportDescription>();
-    ExportDescription right_exp = right.data(
-                                      ExportsModel::ExportDescriptionRole).value<ExportDescription>();
+    const ColumnarTable &table = static_cast<ExportsModel *>(sourceModel())->getTable();
+    int l = left.row();
+    int r = right.row();
 
     switch (left.column()) {
     case ExportsModel::SIZE:
-        if (left_exp.size != right_exp.size)
-            return left_exp.size < right_exp.size;
+        if (table.number(ExportsModel::SizeNumber, l) != table.number(ExportsModel::SizeNumber, r))
+            return table.numberLessThan(ExportsModel::SizeNumber, l, r);
     // fallthrough
     case ExportsModel::OFFSET:
-        if (left_exp.vaddr != right_exp.vaddr)
-            return left_exp.vaddr < right_exp.vaddr;
+        if (table.number(ExportsModel::OffsetNumber, l)
+                != table.number(ExportsModel::OffsetNumber, r))
+            return table.numberLessThan(ExportsModel::OffsetNumber, l, r);
     // fallthrough
     case ExportsModel::NAME:
-        return left_exp.name < right_exp.name;
+        return table.stringLessThan(ExportsModel::NameString, l, r);
     case ExportsModel::TYPE:
-        if (left_exp.type != right_exp.type)
-            return left_exp.type < right_exp.type;
+        if (table.string(ExportsModel::TypeString, l) != table.string(ExportsModel::TypeString, r))
+            return table.stringLessThan(ExportsModel::TypeString, l, r);
     default:
         break;
     }
 
     // fallback
-    return left_exp.vaddr < right_exp.vaddr;
+    return table.numberLessThan(ExportsModel::OffsetNumber, l, r);
 }
 
 
@@ -5,6 +5,7 @@
 
 #include "Cutter.h"
 #include "CutterDockWidget.h"
+#include "utils/ColumnarTable.h"
 
 #include <QAbstractListModel>
 #include <QSortFilterProxyModel>
@@ -27,9 +28,13 @@ class ExportsModel: public QAbstractListModel
 
 private:
     QList<ExportDescription> *exports;
+    // Same rows as exports, for the proxy
+    ColumnarTable table;
 
 public:
     enum Columns { OFFSET = 0, SIZE, TYPE, NAME, COUNT };
+    enum TableNumber { OffsetNumber = 0, SizeNumber, NumberCount };
+    enum TableString { NameString = 0, TypeString, StringCount };
     static const int ExportDescriptionRole = Qt::UserRole;
 
     ExportsModel(QList<ExportDescription> *exports, QObject *parent = 0);
@@ -42,6 +47,11 @@ public:
 
     void beginReloadExports();
     void endReloadExports();
+
+    const ColumnarTable &getTable() const
+    {
+        return table;
+    }
 };
 
 
@@ -10,7 +10,8 @@
 
 FlagsModel::FlagsModel(QList<FlagDescription> *flags, QObject *parent)
     : QAbstractListModel(parent),
-      flags(flags)
+      flags(flags),
+      table(NumberCount, StringCount)
 {
 }
 
@@ -76,6 +77,14 @@ void FlagsModel::beginReloadFlags()
 
 void FlagsModel::endReloadFlags()
 {
+    table.clear();
+    table.reserve(flags->count());
+    for (const FlagDescription &flag : *flags) {
+        int row = table.appendRow();
+        table.setNumber(OffsetNumber, row, flag.offset);
+        table.setNumber(SizeNumber, row, flag.size);
+        table.setString(NameString, row, flag.name);
+    }
     endResetModel();
 }
 
@@ -84,40 +93,50 @@ void FlagsModel::endReloadFlags()
 
 
 FlagsSortFilterProxyModel::FlagsSortFilterProxyModel(FlagsModel *source_model, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : QSortFilterProxyModel(parent),
+      filterEngine(new FilterEngine(this))
 {
+    filterEngine->setSource(source_model->getTable(), FlagsModel::NameString);
+
+    // Connected before setSourceModel(), so the engine has the new rows before the proxy maps them
+    connect(source_model, &QAbstractItemModel::modelReset, this, [this, source_model]() {
+        filterEngine->setSource(source_model->getTable(), FlagsModel::NameString);
+    });
+    connect(filterEngine, &FilterEngine::resultsReady, this, [this]() {
+        invalidateFilter();
+    });
+
     setSourceModel(source_model);
 }
 
-bool FlagsSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
+bool FlagsSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &) const
 {
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    FlagDescription flag = index.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
-    return flag.name.contains(filterRegExp());
+    return filterEngine->accepts(row);
 }
 
 bool FlagsSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
-    FlagDescription left_flag = left.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
-    FlagDescription right_flag = right.data(FlagsModel::FlagDescriptionRole).value<FlagDescription>();
+    const ColumnarTable &table = static_cast<FlagsModel *>(sourceModel())->getTable();
+    int l = left.row();
+    int r = right.row();
 
     switch (left.column()) {
     case FlagsModel::SIZE:
-        if (left_flag.size != right_flag.size)
-            return left_flag.size < right_flag.size;
+        if (table.number(FlagsModel::SizeNumber, l) != table.number(FlagsModel::SizeNumber, r))
+            return table.numberLessThan(FlagsModel::SizeNumber, l, r);
     // fallthrough
     case FlagsModel::OFFSET:
-        if (left_flag.offset != right_flag.offset)
-            return left_flag.offset < right_flag.offset;
+        if (table.number(FlagsModel::OffsetNumber, l) != table.number(FlagsModel::OffsetNumber, r))
+            return table.numberLessThan(FlagsModel::OffsetNumber, l, r);
     // fallthrough
     case FlagsModel::NAME:
-        return left_flag.name < right_flag.name;
+        return table.stringLessThan(FlagsModel::NameString, l, r);
     default:
         break;
     }
 
     // fallback
-    return left_flag.offset < right_flag.offset;
+    return table.numberLessThan(FlagsModel::OffsetNumber, l, r);
 }
 
 
@@ -130,8 +149,8 @@ FlagsWidget::FlagsWidget(MainWindow *main, QAction *action) :
 
     flags_model = new FlagsModel(&flags, this);
     flags_proxy_model = new FlagsSortFilterProxyModel(flags_model, this);
-    connect(ui->filterLineEdit, SIGNAL(textChanged(const QString &)), flags_proxy_model,
-            SLOT(setFilterWildcard(const QString &)));
+    connect(ui->filterLineEdit, &QLineEdit::textChanged,
+            flags_proxy_model->getFilterEngine(), &FilterEngine::setQuery);
     ui->flagsTreeView->setModel(flags_proxy_model);
     ui->flagsTreeView->sortByColumn(FlagsModel::OFFSET, Qt::AscendingOrder);
 
@@ -229,13 +248,6 @@ void FlagsWidget::refreshFlags()
 
     ui->flagsTreeView->resizeColumnToContents(0);
     ui->flagsTreeView->resizeColumnToContents(1);
-
-
-    // TODO: this is not a very good place for the following:
-    QStringList flagNames;
-    for (auto i : flags)
-        flagNames.append(i.name);
-    main->refreshOmniBar(flagNames);
 }
 
 void FlagsWidget::setScrollMode()
@@ -8,6 +8,8 @@
 
 #include "Cutter.h"
 #include "CutterDockWidget.h"
+#include "utils/ColumnarTable.h"
+#include "utils/FilterEngine.h"
 
 class MainWindow;
 class QTreeWidgetItem;
@@ -19,9 +21,13 @@ class FlagsModel: public QAbstractListModel
 
 private:
     QList<FlagDescription> *flags;
+    // Same rows as flags, for the proxy
+    ColumnarTable table;
 
 public:
     enum Columns { OFFSET = 0, SIZE, NAME, COUNT };
+    enum TableNumber { OffsetNumber = 0, SizeNumber, NumberCount };
+    enum TableString { NameString = 0, StringCount };
     static const int FlagDescriptionRole = Qt::UserRole;
 
     FlagsModel(QList<FlagDescription> *flags, QObject *parent = 0);
@@ -34,6 +40,11 @@ public:
 
     void beginReloadFlags();
     void endReloadFlags();
+
+    const ColumnarTable &getTable() const
+    {
+        return table;
+    }
 };
 
 
@@ -45,9 +56,18 @@ class FlagsSortFilterProxyModel : public QSortFilterProxyModel
 public:
     FlagsSortFilterProxyModel(FlagsModel *source_model, QObject *parent = 0);
 
+    // Filters by flag name, replaces setFilterWildcard()
+    FilterEngine *getFilterEngine() const
+    {
+        return filterEngine;
+    }
+
 protected:
     bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private:
+    FilterEngine *filterEngine;
 };
 
 
@@ -14,6 +14,97 @@
 #include <QResource>
 #include <QShortcut>
 #include <QJsonObject>
+#include <QToolTip>
+#include <QCursor>
+#include <QHeaderView>
+
+FunctionTooltipTask::FunctionTooltipTask(RVA offset, int generation)
+    : offset(offset),
+      generation(generation)
+{
+}
+
+void FunctionTooltipTask::run()
+{
+    int size;
+    int complexity;
+    int basicBlocks;
+    {
+        RCoreLocked core = Core()->core();
+        RAnalFunction *fcn = r_anal_get_fcn_at(core->anal, offset, R_ANAL_FCN_TYPE_NULL);
+        if (!fcn) {
+            emit finished(generation, offset, QString());
+            return;
+        }
+        size = r_anal_fcn_size(fcn);
+        complexity = r_anal_fcn_cc(fcn);
+        basicBlocks = r_list_length(fcn->bbs);
+    }
+
+    // The core stays locked only for one command at a time
+    QString at = " @ " + RAddressString(offset);
+    QString preview = Core()->cmd("pdi 10" + at);
+    QString strings = Core()->cmd("pdsf" + at);
+
+    QString tooltip = QString("Summary:\n\n    Size: %1"
+                              "\n    Cyclomatic complexity: %2"
+                              "\n    Basic blocks: %3"
+                              "\n\nDisasm preview:\n\n%4"
+                              "\nStrings:\n\n%5")
+                      .arg(size).arg(complexity).arg(basicBlocks).arg(preview, strings);
+    emit finished(generation, offset, tooltip);
+}
+
+FunctionTooltipCache::FunctionTooltipCache(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<RVA>("RVA");
+    // Every task locks the core, more threads would only wait for each other
+    pool.setMaxThreadCount(1);
+}
+
+FunctionTooltipCache::~FunctionTooltipCache()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+QString FunctionTooltipCache::tooltip(RVA offset)
+{
+    auto it = tooltips.constFind(offset);
+    if (it != tooltips.constEnd()) {
+        return it.value();
+    }
+
+    if (!pending.contains(offset)) {
+        // Tooltips the mouse already left are not needed anymore
+        pool.clear();
+        pending.clear();
+        pending.insert(offset);
+        FunctionTooltipTask *task = new FunctionTooltipTask(offset, generation);
+        connect(task, &FunctionTooltipTask::finished, this, &FunctionTooltipCache::taskFinished);
+        pool.start(task);
+    }
+    return tr("Loading...");
+}
+
+void FunctionTooltipCache::clear()
+{
+    generation++;
+    pool.clear();
+    pending.clear();
+    tooltips.clear();
+}
+
+void FunctionTooltipCache::taskFinished(int generation, RVA offset, const QString &tooltip)
+{
+    if (generation != this->generation) {
+        return;
+    }
+    pending.remove(offset);
+    tooltips.insert(offset, tooltip);
+    emit tooltipReady(offset);
+}
 
 FunctionModel::FunctionModel(QList<FunctionDescription> *functions, QSet<RVA> *importAddresses,
                              ut64 *mainAdress, bool nested, QFont default_font, QFont highlight_font, QObject *parent)
@@ -24,8 +115,9 @@ FunctionModel::FunctionModel(QList<FunctionDescription> *functions, QSet<RVA> *i
       highlightFont(highlight_font),
       defaultFont(default_font),
       nested(nested),
-      currentIndex(-1)
-
+      currentIndex(-1),
+      table(NumberCount, StringCount),
+      tooltipCache(new FunctionTooltipCache(this))
 {
     connect(Core(), SIGNAL(seekChanged(RVA)), this, SLOT(seekChanged(RVA)));
     connect(Core(), SIGNAL(functionRenamed(const QString &, const QString &)), this,
@@ -128,6 +220,8 @@ QVariant FunctionModel::data(const QModelIndex &index, int role) const
             case OffsetColumn:
                 return RAddressString(function.offset);
             default:
+                if (isMetricColumn(index.column()) && metricsAvailable)
+                    return qulonglong(table.number(metricNumber(index.column()), function_index));
                 return QVariant();
             }
         }
@@ -144,23 +238,15 @@ QVariant FunctionModel::data(const QModelIndex &index, int role) const
         return defaultFont;
 
     case Qt::TextAlignmentRole:
-        if (index.column() == 1)
+        if (index.column() == SizeColumn || isMetricColumn(index.column()))
             return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
         return static_cast<int>(Qt::AlignLeft | Qt::AlignVCenter);
 
     case Qt::ToolTipRole: {
-        QList<QString> info = CutterCore::getInstance()->cmd("afi @ " + function.name).split("\n");
-        if (info.length() > 2) {
-            QString size = info[4].split(" ")[1];
-            QString complex = info[8].split(" ")[1];
-            QString bb = info[11].split(" ")[1];
-            return QString("Summary:\n\n    Size: " + size +
-                           "\n    Cyclomatic complexity: " + complex +
-                           "\n    Basic blocks: " + bb +
-                           "\n\nDisasm preview:\n\n" + CutterCore::getInstance()->cmd("pdi 10 @ " + function.name) +
-                           "\nStrings:\n\n" + CutterCore::getInstance()->cmd("pdsf @ " + function.name));
-        }
-        return QVariant();
+        QString tooltip = tooltipCache->tooltip(function.offset);
+        if (tooltip.isEmpty())
+            return QVariant();
+        return tooltip;
     }
 
     case Qt::ForegroundRole:
@@ -196,6 +282,22 @@ QVariant FunctionModel::headerData(int section, Qt::Orientation orientation, int
                 return tr("Imp.");
             case OffsetColumn:
                 return tr("Offset");
+            case BasicBlocksColumn:
+                return tr("Blocks");
+            case EdgesColumn:
+                return tr("Edges");
+            case ComplexityColumn:
+                return tr("Complexity");
+            case InstructionsColumn:
+                return tr("Instructions");
+            case CallsColumn:
+                return tr("Calls");
+            case XrefsInColumn:
+                return tr("Xrefs in");
+            case StackFrameColumn:
+                return tr("Stack");
+            case StringRefsColumn:
+                return tr("Strings");
             default:
                 return QVariant();
             }
@@ -212,10 +314,52 @@ void FunctionModel::beginReloadFunctions()
 
 void FunctionModel::endReloadFunctions()
 {
+    tooltipCache->clear();
+    metricsAvailable = false;
+    table.clear();
+    table.reserve(functions->count());
+    for (const FunctionDescription &function : *functions) {
+        int row = table.appendRow();
+        table.setNumber(OffsetNumber, row, function.offset);
+        table.setNumber(SizeNumber, row, function.size);
+        table.setNumber(ImportNumber, row, functionIsImport(function.offset));
+        table.setString(NameString, row, function.name);
+    }
+
+    updateRanges();
     updateCurrentIndex();
     endResetModel();
 }
 
+void FunctionModel::setMetrics(const QVector<FunctionMetrics> &metrics)
+{
+    QHash<RVA, int> rows;
+    rows.reserve(functions->count());
+    for (int i = 0; i < functions->count(); i++) {
+        rows.insert(functions->at(i).offset, i);
+    }
+
+    for (const FunctionMetrics &function : metrics) {
+        int row = rows.value(function.offset, -1);
+        if (row < 0)
+            continue;
+        table.setNumber(BasicBlocksNumber, row, function.basicBlocks);
+        table.setNumber(EdgesNumber, row, function.edges);
+        table.setNumber(ComplexityNumber, row, function.complexity);
+        table.setNumber(InstructionsNumber, row, function.instructions);
+        table.setNumber(CallsNumber, row, function.calls);
+        table.setNumber(XrefsInNumber, row, function.xrefsIn);
+        table.setNumber(StackFrameNumber, row, function.stackFrame);
+        table.setNumber(StringRefsNumber, row, function.stringRefs);
+    }
+    metricsAvailable = true;
+
+    if (!nested && !functions->isEmpty()) {
+        emit dataChanged(index(0, BasicBlocksColumn),
+                         index(functions->count() - 1, ColumnCount - 1));
+    }
+}
+
 void FunctionModel::setNested(bool nested)
 {
     beginResetModel();
@@ -226,27 +370,27 @@ void FunctionModel::setNested(bool nested)
 
 void FunctionModel::seekChanged(RVA)
 {
+    int previousIndex = currentIndex;
     if (updateCurrentIndex()) {
-        emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
+        emitRowChanged(previousIndex);
+        emitRowChanged(currentIndex);
     }
 }
 
-bool FunctionModel::updateCurrentIndex()
+void FunctionModel::emitRowChanged(int row)
 {
-    int index = -1;
-    RVA offset = 0;
-
-    RVA seek = Core()->getOffset();
-
-    for (int i = 0; i < functions->count(); i++) {
-        const FunctionDescription &function = functions->at(i);
-
-        if (function.contains(seek)
-                && function.offset >= offset) {
-            offset = function.offset;
-            index = i;
-        }
+    if (row < 0 || row >= functions->count())
+        return;
+    emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    if (nested) {
+        QModelIndex parent = index(row, 0);
+        emit dataChanged(index(0, 0, parent), index(rowCount(parent) - 1, 0, parent));
     }
+}
+
+bool FunctionModel::updateCurrentIndex()
+{
+    int index = functionIndexAt(Core()->getOffset());
 
     bool changed = currentIndex != index;
 
@@ -255,12 +399,29 @@ bool FunctionModel::updateCurrentIndex()
     return changed;
 }
 
+void FunctionModel::updateRanges()
+{
+    // Same choice as the old linear search: the highest start, then the last in the list
+    functionRanges.clear();
+    for (int i = 0; i < functions->count(); i++) {
+        const FunctionDescription &function = functions->at(i);
+        functionRanges.add(function.offset, function.offset + function.size, i);
+    }
+    functionRanges.build();
+}
+
+int FunctionModel::functionIndexAt(RVA addr) const
+{
+    return functionRanges.at(addr);
+}
+
 void FunctionModel::functionRenamed(const QString &prev_name, const QString &new_name)
 {
     for (int i = 0; i < functions->count(); i++) {
         FunctionDescription &function = (*functions)[i];
         if (function.name == prev_name) {
             function.name = new_name;
+            table.setString(NameString, i, new_name);
             emit dataChanged(index(i, 0), index(i, columnCount() - 1));
         }
     }
@@ -268,19 +429,30 @@ void FunctionModel::functionRenamed(const QString &prev_name, const QString &new
 
 FunctionSortFilterProxyModel::FunctionSortFilterProxyModel(FunctionModel *source_model,
                                                            QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : QSortFilterProxyModel(parent),
+      filterEngine(new FilterEngine(this))
 {
+    filterEngine->setCaseSensitivity(Qt::CaseInsensitive);
+    filterEngine->setSource(source_model->getTable(), FunctionModel::NameString);
+
+    // Connected before setSourceModel(), so the engine has the new rows before the proxy maps them
+    auto updateSource = [this, source_model]() {
+        filterEngine->setSource(source_model->getTable(), FunctionModel::NameString);
+    };
+    connect(source_model, &QAbstractItemModel::modelReset, this, updateSource);
+    connect(source_model, &QAbstractItemModel::dataChanged, this, updateSource);
+    connect(filterEngine, &FilterEngine::resultsReady, this, [this]() {
+        invalidateFilter();
+    });
+
     setSourceModel(source_model);
-    setFilterCaseSensitivity(Qt::CaseInsensitive);
     setSortCaseSensitivity(Qt::CaseInsensitive);
 }
 
 bool FunctionSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
 {
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    FunctionDescription function = index.data(
-                                       FunctionModel::FunctionDescriptionRole).value<FunctionDescription>();
-    return function.name.contains(filterRegExp());
+    // Sub-nodes show the function of their parent
+    return filterEngine->accepts(parent.isValid() ? parent.row() : row);
 }
 
 bool FunctionSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
@@ -291,36 +463,39 @@ bool FunctionSortFilterProxyModel::lessThan(const QModelIndex &left, const QMode
     if (left.parent().isValid() || right.parent().isValid())
         return false;
 
-    FunctionDescription left_function = left.data(
-                                            FunctionModel::FunctionDescriptionRole).value<FunctionDescription>();
-    FunctionDescription right_function = right.data(
-                                             FunctionModel::FunctionDescriptionRole).value<FunctionDescription>();
-
+    auto model = static_cast<FunctionModel *>(sourceModel());
+    const ColumnarTable &table = model->getTable();
+    int l = left.row();
+    int r = right.row();
 
-    if (static_cast<FunctionModel *>(sourceModel())->isNested()) {
-        return left_function.name < right_function.name;
+    if (model->isNested()) {
+        return table.stringLessThan(FunctionModel::NameString, l, r);
     } else {
         switch (left.column()) {
         case FunctionModel::OffsetColumn:
-            return left_function.offset < right_function.offset;
+            return table.numberLessThan(FunctionModel::OffsetNumber, l, r);
         case FunctionModel::SizeColumn:
-            if (left_function.size != right_function.size)
-                return left_function.size < right_function.size;
+            if (table.number(FunctionModel::SizeNumber, l)
+                    != table.number(FunctionModel::SizeNumber, r))
+                return table.numberLessThan(FunctionModel::SizeNumber, l, r);
             break;
-        case FunctionModel::ImportColumn: {
-            bool left_is_import = left.data(FunctionModel::IsImportRole).toBool();
-            bool right_is_import = right.data(FunctionModel::IsImportRole).toBool();
-            if (!left_is_import && right_is_import)
-                return true;
+        case FunctionModel::ImportColumn:
+            if (table.number(FunctionModel::ImportNumber, l)
+                    != table.number(FunctionModel::ImportNumber, r))
+                return table.numberLessThan(FunctionModel::ImportNumber, l, r);
             break;
-        }
         case FunctionModel::NameColumn:
-            return left_function.name < right_function.name;
+            return table.stringLessThan(FunctionModel::NameString, l, r);
         default:
-            return false;
+            if (!FunctionModel::isMetricColumn(left.column()))
+                return false;
+            int number = FunctionModel::metricNumber(left.column());
+            if (table.number(number, l) != table.number(number, r))
+                return table.numberLessThan(number, l, r);
+            break;
         }
 
-        return left_function.offset < right_function.offset;
+        return table.numberLessThan(FunctionModel::OffsetNumber, l, r);
     }
 }
 
@@ -356,8 +531,8 @@ FunctionsWidget::FunctionsWidget(MainWindow *main, QAction *action) :
     ui->functionsTreeView->setModel(functionProxyModel);
     ui->functionsTreeView->sortByColumn(FunctionModel::NameColumn, Qt::AscendingOrder);
 
-    connect(ui->quickFilterView, SIGNAL(filterTextChanged(const QString &)), functionProxyModel,
-            SLOT(setFilterWildcard(const QString &)));
+    connect(ui->quickFilterView, &QuickFilterView::filterTextChanged,
+            functionProxyModel->getFilterEngine(), &FilterEngine::setQuery);
     connect(ui->quickFilterView, SIGNAL(filterClosed()), ui->functionsTreeView, SLOT(setFocus()));
 
     setScrollMode();
@@ -369,6 +544,15 @@ FunctionsWidget::FunctionsWidget(MainWindow *main, QAction *action) :
     connect(ui->functionsTreeView, SIGNAL(doubleClicked(const QModelIndex &)), this,
             SLOT(onFunctionsDoubleClicked(const QModelIndex &)));
 
+    connect(functionModel->getTooltipCache(), &FunctionTooltipCache::tooltipReady,
+            this, &FunctionsWidget::updateTooltip);
+
+    // Metric columns are hidden until picked from the header's context menu
+    ui->functionsTreeView->header()->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->functionsTreeView->header(), &QWidget::customContextMenuRequested,
+            this, &FunctionsWidget::showHeaderContextMenu);
+    updateMetricColumns();
+
     // Use a custom context menu on the dock title bar
     //this->title_bar = this->titleBarWidget();
     ui->actionHorizontal->setChecked(true);
@@ -395,6 +579,14 @@ void FunctionsWidget::refreshTree()
     mainAdress = (ut64)CutterCore::getInstance()->cmdj("iMj").object()["vaddr"].toInt();
 
     functionModel->endReloadFunctions();
+    updateMetricColumns();
+
+    // Deleting the old job waits for it, so its results never reach the new functions
+    delete metricsJob;
+    metricsJob = new FunctionMetricsJob(this);
+    connect(metricsJob, &FunctionMetricsJob::metricsReady, functionModel,
+            &FunctionModel::setMetrics);
+    metricsJob->start();
 
     // resize offset and size columns
     ui->functionsTreeView->resizeColumnToContents(0);
@@ -402,6 +594,29 @@ void FunctionsWidget::refreshTree()
     ui->functionsTreeView->resizeColumnToContents(2);
 }
 
+// Replaces the placeholder if the tooltip of that function is still shown
+void FunctionsWidget::updateTooltip(RVA offset)
+{
+    if (!QToolTip::isVisible())
+        return;
+
+    QWidget *viewport = ui->functionsTreeView->viewport();
+    QPoint pos = QCursor::pos();
+    QModelIndex index = ui->functionsTreeView->indexAt(viewport->mapFromGlobal(pos));
+    if (!index.isValid())
+        return;
+    FunctionDescription function = index.data(
+                                       FunctionModel::FunctionDescriptionRole).value<FunctionDescription>();
+    if (function.offset != offset)
+        return;
+
+    QString tooltip = index.data(Qt::ToolTipRole).toString();
+    if (tooltip.isEmpty())
+        QToolTip::hideText();
+    else
+        QToolTip::showText(pos, tooltip, viewport);
+}
+
 void FunctionsWidget::onFunctionsDoubleClicked(const QModelIndex &index)
 {
     FunctionDescription function = index.data(
@@ -512,6 +727,40 @@ void FunctionsWidget::on_actionHorizontal_triggered()
 {
     functionModel->setNested(false);
     ui->functionsTreeView->setIndentation(8);
+    updateMetricColumns();
+}
+
+void FunctionsWidget::showHeaderContextMenu(const QPoint &pt)
+{
+    if (functionModel->isNested())
+        return;
+
+    QMenu menu(this);
+    for (int column = FunctionModel::BasicBlocksColumn; column < FunctionModel::ColumnCount;
+            column++) {
+        QString title = functionModel->headerData(column, Qt::Horizontal).toString();
+        QAction *action = menu.addAction(title);
+        action->setCheckable(true);
+        action->setChecked(shownMetricColumns.contains(column));
+        connect(action, &QAction::toggled, this, [this, column](bool checked) {
+            if (checked)
+                shownMetricColumns.insert(column);
+            else
+                shownMetricColumns.remove(column);
+            updateMetricColumns();
+        });
+    }
+    menu.exec(ui->functionsTreeView->header()->mapToGlobal(pt));
+}
+
+void FunctionsWidget::updateMetricColumns()
+{
+    if (functionModel->isNested())
+        return;
+    for (int column = FunctionModel::BasicBlocksColumn; column < FunctionModel::ColumnCount;
+            column++) {
+        ui->functionsTreeView->setColumnHidden(column, !shownMetricColumns.contains(column));
+    }
 }
 
 void FunctionsWidget::on_actionVertical_triggered()
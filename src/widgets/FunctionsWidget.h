@@ -5,9 +5,15 @@
 
 #include <QSortFilterProxyModel>
 #include <QTreeView>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include "Cutter.h"
 #include "CutterDockWidget.h"
+#include "utils/AddressRangeIndex.h"
+#include "utils/ColumnarTable.h"
+#include "utils/FilterEngine.h"
+#include "utils/FunctionMetrics.h"
 
 class MainWindow;
 class QTreeWidgetItem;
@@ -17,6 +23,63 @@ class FunctionsWidget;
 }
 
 
+/*!
+ * \brief Computes the tooltip of one function on a worker thread
+ */
+class FunctionTooltipTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    FunctionTooltipTask(RVA offset, int generation);
+
+    void run() override;
+
+signals:
+    // tooltip is empty if there is no function at offset anymore
+    void finished(int generation, RVA offset, const QString &tooltip);
+
+private:
+    RVA offset;
+    int generation;
+};
+
+
+/*!
+ * \brief Tooltips of the functions in FunctionModel, computed once per function and generation
+ *
+ * Tooltips not computed yet are requested from a worker thread and shown as a
+ * placeholder meanwhile. Only the last requested one is kept in the queue, so
+ * moving the mouse over the list does not pile up work.
+ */
+class FunctionTooltipCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FunctionTooltipCache(QObject *parent = nullptr);
+    ~FunctionTooltipCache();
+
+    // The cached tooltip, or the placeholder while it is being computed
+    QString tooltip(RVA offset);
+
+    // Drops all tooltips, results of tasks still running are ignored
+    void clear();
+
+signals:
+    void tooltipReady(RVA offset);
+
+private slots:
+    void taskFinished(int generation, RVA offset, const QString &tooltip);
+
+private:
+    QThreadPool pool;
+    int generation = 0;
+    QHash<RVA, QString> tooltips;
+    QSet<RVA> pending;
+};
+
+
 class FunctionModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -33,15 +96,38 @@ private:
 
     int currentIndex;
 
+    // Innermost function containing an address, as an index into functions
+    AddressRangeIndex functionRanges;
+
+    // Same rows as functions, for the proxy
+    ColumnarTable table;
+    // Whether the metric numbers in table are filled in for the current functions
+    bool metricsAvailable = false;
+
+    FunctionTooltipCache *tooltipCache;
+
     bool functionIsImport(ut64 addr) const;
 
     bool functionIsMain(ut64 addr) const;
 
+    void updateRanges();
+    int functionIndexAt(RVA addr) const;
+    void emitRowChanged(int row);
+
 public:
     static const int FunctionDescriptionRole = Qt::UserRole;
     static const int IsImportRole = Qt::UserRole + 1;
 
-    enum Column { NameColumn = 0, SizeColumn, ImportColumn, OffsetColumn, ColumnCount };
+    // The columns from BasicBlocksColumn on show FunctionMetrics, they are optional
+    enum Column { NameColumn = 0, SizeColumn, ImportColumn, OffsetColumn,
+                  BasicBlocksColumn, EdgesColumn, ComplexityColumn, InstructionsColumn,
+                  CallsColumn, XrefsInColumn, StackFrameColumn, StringRefsColumn, ColumnCount
+                };
+    enum TableNumber { OffsetNumber = 0, SizeNumber, ImportNumber,
+                       BasicBlocksNumber, EdgesNumber, ComplexityNumber, InstructionsNumber,
+                       CallsNumber, XrefsInNumber, StackFrameNumber, StringRefsNumber, NumberCount
+                     };
+    enum TableString { NameString = 0, StringCount };
 
     FunctionModel(QList<FunctionDescription> *functions, QSet<RVA> *importAddresses, ut64 *mainAdress,
                   bool nested, QFont defaultFont, QFont highlightFont, QObject *parent = 0);
@@ -58,11 +144,34 @@ public:
     void beginReloadFunctions();
     void endReloadFunctions();
 
+    // Fills the metric columns, metrics of functions not in the model are ignored
+    void setMetrics(const QVector<FunctionMetrics> &metrics);
+
+    static bool isMetricColumn(int column)
+    {
+        return column >= BasicBlocksColumn && column < ColumnCount;
+    }
+    // The number holding a metric column in the table
+    static int metricNumber(int column)
+    {
+        return column - BasicBlocksColumn + BasicBlocksNumber;
+    }
+
     /*!
      * @return true if the index changed
      */
     bool updateCurrentIndex();
 
+    const ColumnarTable &getTable() const
+    {
+        return table;
+    }
+
+    FunctionTooltipCache *getTooltipCache() const
+    {
+        return tooltipCache;
+    }
+
     void setNested(bool nested);
     bool isNested()
     {
@@ -82,9 +191,18 @@ class FunctionSortFilterProxyModel : public QSortFilterProxyModel
 public:
     FunctionSortFilterProxyModel(FunctionModel *source_model, QObject *parent = 0);
 
+    // Filters by function name, replaces setFilterWildcard()
+    FilterEngine *getFilterEngine() const
+    {
+        return filterEngine;
+    }
+
 protected:
     bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private:
+    FilterEngine *filterEngine;
 };
 
 
@@ -112,6 +230,8 @@ private slots:
     void showTitleContextMenu(const QPoint &pt);
 
     void refreshTree();
+    void updateTooltip(RVA offset);
+    void showHeaderContextMenu(const QPoint &pt);
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
@@ -127,7 +247,13 @@ private:
     FunctionModel *functionModel;
     FunctionSortFilterProxyModel *functionProxyModel;
 
+    // Computes the metrics of the functions loaded by the last refresh
+    FunctionMetricsJob *metricsJob = nullptr;
+    // Metric columns picked in the header's context menu, all others are hidden
+    QSet<int> shownMetricColumns;
+
     void setScrollMode();
+    void updateMetricColumns();
 };
 
 
@@ -0,0 +1,844 @@
+#include "GraphLayout.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <queue>
+
+GraphLayout::GraphLayout()
+{
+}
+
+GraphLayout::GraphLayout(const Config &config)
+    : config(config)
+{
+}
+
+// Vector functions
+template<class T>
+static void initVec(std::vector<T> &vec, size_t size, T value)
+{
+    vec.resize(size);
+    for (size_t i = 0; i < size; i++)
+        vec[i] = value;
+}
+
+static bool isCancelled(const QAtomicInt *cancelled)
+{
+    return cancelled && cancelled->load();
+}
+
+void GraphLayout::addBlock(ut64 entry, int width, int height, const std::vector<ut64> &exits)
+{
+    Block block;
+    block.entry = entry;
+    block.width = width;
+    block.height = height;
+    block.exits = exits;
+    blocks[entry] = block;
+}
+
+// Maps every block to an index once, so the layout itself never has to hash an address
+void GraphLayout::buildNodes()
+{
+    nodes.clear();
+    nodes.reserve(blocks.size());
+    for (auto &blockIt : blocks) {
+        nodes.push_back(&blockIt.second);
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const Block * a, const Block * b) {
+        return a->entry < b->entry;
+    });
+
+    std::unordered_map<ut64, int> indexOf;
+    indexOf.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        indexOf[nodes[i]->entry] = int(i);
+    }
+
+    exit_start.clear();
+    exit_index.clear();
+    exit_start.reserve(nodes.size() + 1);
+    for (Block *block : nodes) {
+        exit_start.push_back(int(exit_index.size()));
+        for (ut64 edge : block->exits) {
+            exit_index.push_back(indexOf[edge]);
+        }
+    }
+    exit_start.push_back(int(exit_index.size()));
+}
+
+// This calculates the full graph starting at block entry.
+bool GraphLayout::compute(ut64 entry, const QAtomicInt *cancelled)
+{
+    // Exits to blocks which are not part of the graph get an empty placeholder block
+    std::vector<ut64> missing_blocks;
+    for (auto &blockIt : blocks) {
+        for (ut64 edge : blockIt.second.exits) {
+            if (!blocks.count(edge)) {
+                missing_blocks.push_back(edge);
+            }
+        }
+    }
+    if (!blocks.count(entry)) {
+        missing_blocks.push_back(entry);
+    }
+    for (ut64 missing : missing_blocks) {
+        addBlock(missing, 0, 0, std::vector<ut64>());
+    }
+
+    buildNodes();
+    int root = int(std::lower_bound(nodes.begin(), nodes.end(), entry,
+    [](const Block * block, ut64 addr) {
+        return block->entry < addr;
+    }) - nodes.begin());
+
+    std::vector<int> block_order;
+    int row_count, col_count;
+    if (config.layoutType == LayoutType::Layered) {
+        if (!computeLayeredLayout(root, block_order, row_count, col_count, cancelled)) {
+            return false;
+        }
+    } else {
+        if (!extractTree(root, block_order, cancelled)) {
+            return false;
+        }
+        computeGraphLayout(root);
+        row_count = nodes[root]->row_count;
+        col_count = nodes[root]->col_count;
+    }
+
+    // Prepare edge routing
+    // The grids are kept per thread so following layouts reuse their memory
+    static thread_local LaneGrid horiz_edges, vert_edges;
+    grid_rows = row_count + 1;
+    grid_cols = col_count + 1;
+    horiz_edges.reset(grid_rows, grid_cols);
+    vert_edges.reset(grid_cols, grid_rows);
+
+    std::vector<int> blocks_in_cell;
+    initVec(blocks_in_cell, size_t(grid_cols) * grid_rows, 0);
+    for (Block *block : nodes) {
+        blocks_in_cell[size_t(block->col + 1) * grid_rows + block->row] = 1;
+    }
+    initVec(blocked_rows, size_t(grid_cols) * (grid_rows + 1), 0);
+    for (int col = 0; col < grid_cols; col++) {
+        int *prefix = &blocked_rows[size_t(col) * (grid_rows + 1)];
+        for (int row = 0; row < grid_rows; row++) {
+            prefix[row + 1] = prefix[row] + blocks_in_cell[size_t(col) * grid_rows + row];
+        }
+    }
+
+    // Perform edge routing
+    for (int index : block_order) {
+        if (isCancelled(cancelled)) {
+            horiz_edges.trim();
+            vert_edges.trim();
+            return false;
+        }
+        Block &start = *nodes[index];
+        for (int i = exit_start[index]; i < exit_start[index + 1]; i++) {
+            Block &end = *nodes[exit_index[i]];
+            start.edges.push_back(routeEdge(horiz_edges, vert_edges, start, end));
+        }
+    }
+
+    // Compute edge counts for each row and column
+    std::vector<int> col_edge_count, row_edge_count;
+    initVec(col_edge_count, col_count + 1, 0);
+    initVec(row_edge_count, row_count + 1, 0);
+    for (int row = 0; row < row_count + 1; row++) {
+        for (int col = 0; col < col_count + 1; col++) {
+            row_edge_count[row] = std::max(row_edge_count[row], horiz_edges.extent(row, col));
+            col_edge_count[col] = std::max(col_edge_count[col], vert_edges.extent(col, row));
+        }
+    }
+    horiz_edges.trim();
+    vert_edges.trim();
+    std::vector<int>().swap(blocked_rows);
+
+
+    //Compute row and column sizes
+    std::vector<int> col_width, row_height;
+    initVec(col_width, col_count + 1, 0);
+    initVec(row_height, row_count + 1, 0);
+    for (Block *block : nodes) {
+        if ((int(block->width / 2)) > col_width[block->col])
+            col_width[block->col] = int(block->width / 2);
+        if ((int(block->width / 2)) > col_width[block->col + 1])
+            col_width[block->col + 1] = int(block->width / 2);
+        if (int(block->height) > row_height[block->row])
+            row_height[block->row] = int(block->height);
+    }
+
+    // Compute row and column positions
+    std::vector<int> col_x, row_y;
+    initVec(col_x, col_count, 0);
+    initVec(row_y, row_count, 0);
+    initVec(col_edge_x, col_count + 1, 0);
+    initVec(row_edge_y, row_count + 1, 0);
+    int block_horizontal_margin = config.block_horizontal_margin;
+    int block_vertical_margin = config.block_vertical_margin;
+    int x = block_horizontal_margin * 2;
+    for (int i = 0; i < col_count; i++) {
+        col_edge_x[i] = x;
+        x += block_horizontal_margin * col_edge_count[i];
+        col_x[i] = x;
+        x += col_width[i];
+    }
+    int y = block_vertical_margin * 2;
+    for (int i = 0; i < row_count; i++) {
+        row_edge_y[i] = y;
+        // TODO: The 1 when row_edge_count is 0 is not needed on the original.. not sure why it's required for us
+        if (!row_edge_count[i]) {
+            row_edge_count[i] = 1;
+        }
+        y += block_vertical_margin * row_edge_count[i];
+        row_y[i] = y;
+        y += row_height[i];
+    }
+    col_edge_x[col_count] = x;
+    row_edge_y[row_count] = y;
+    width = x + (block_horizontal_margin * 2) + (block_horizontal_margin *
+                                                 col_edge_count[col_count]);
+    height = y + (block_vertical_margin * 2) + (block_vertical_margin *
+                                                row_edge_count[row_count]);
+
+    //Compute node positions
+    for (Block *blockp : nodes) {
+        Block &block = *blockp;
+        block.x = int(
+                      (col_x[block.col] + col_width[block.col] + ((block_horizontal_margin / 2) * col_edge_count[block.col
+                                                                                                                 + 1])) - (block.width / 2));
+        if ((block.x + block.width) > (
+                    col_x[block.col] + col_width[block.col] + col_width[block.col + 1] + block_horizontal_margin *
+                    col_edge_count[
+                 block.col + 1])) {
+            block.x = int((col_x[block.col] + col_width[block.col] + col_width[block.col + 1] +
+                           block_horizontal_margin * col_edge_count[
+                    block.col + 1]) - block.width);
+        }
+        block.y = row_y[block.row];
+    }
+
+    // Precompute coordinates for edges
+    for (size_t index = 0; index < nodes.size(); index++) {
+        Block &block = *nodes[index];
+
+        for (size_t e = 0; e < block.edges.size(); e++) {
+            Edge &edge = block.edges[e];
+            const Block &dest = *nodes[exit_index[exit_start[index] + e]];
+            auto start = edge.points[0];
+            auto start_col = start.col;
+            auto last_index = edge.start_index;
+            // This is the start point of the edge.
+            auto first_pt = QPoint(col_edge_x[start_col] + (block_horizontal_margin * last_index) +
+                                   (block_horizontal_margin / 2),
+                                   block.y + block.height);
+            auto last_pt = first_pt;
+            QPolygonF pts;
+            pts.append(last_pt);
+
+            for (int i = 0; i < int(edge.points.size()); i++) {
+                auto end = edge.points[i];
+                auto end_row = end.row;
+                auto end_col = end.col;
+                auto last_index = end.index;
+                QPoint new_pt;
+                // block_vertical_margin/2 gives the margin from block to the horizontal lines
+                if (start_col == end_col)
+                    new_pt = QPoint(last_pt.x(), row_edge_y[end_row] + (block_vertical_margin * last_index) +
+                                    (block_vertical_margin / 2));
+                else
+                    new_pt = QPoint(col_edge_x[end_col] + (block_horizontal_margin * last_index) +
+                                    (block_horizontal_margin / 2), last_pt.y());
+                pts.push_back(new_pt);
+                last_pt = new_pt;
+                start_col = end_col;
+            }
+
+            auto new_pt = QPoint(last_pt.x(), dest.y - 1);
+            pts.push_back(new_pt);
+            edge.polyline = pts;
+
+            // Both arrows are always computed, the view decides which ones to draw
+            pts.clear();
+            pts.append(QPoint(first_pt.x() - 3, first_pt.y() + 6));
+            pts.append(QPoint(first_pt.x() + 3, first_pt.y() + 6));
+            pts.append(first_pt);
+            edge.arrow_start = pts;
+
+            pts.clear();
+            pts.append(QPoint(new_pt.x() - 3, new_pt.y() - 6));
+            pts.append(QPoint(new_pt.x() + 3, new_pt.y() - 6));
+            pts.append(new_pt);
+            edge.arrow_end = pts;
+        }
+    }
+
+    return true;
+}
+
+// Builds the spanning tree used for placement.
+// Blocks are taken in BFS order as long as all of their predecessors were placed already.
+// When no such block is left, the unplaced exit with the fewest unplaced predecessors
+// (lowest address on ties) is attached next, found through a heap instead of a rescan.
+bool GraphLayout::extractTree(int root, std::vector<int> &block_order,
+                              const QAtomicInt *cancelled)
+{
+    int count = int(nodes.size());
+    // Used to skip duplicate exits, e.g. a conditional jump to the next block
+    std::vector<int> last_source;
+    initVec(last_source, count, -1);
+
+    // Number of distinct predecessors that were not processed yet
+    std::vector<int> incoming;
+    initVec(incoming, count, 0);
+    for (int index = 0; index < count; index++) {
+        for (int i = exit_start[index]; i < exit_start[index + 1]; i++) {
+            int edge = exit_index[i];
+            if (last_source[edge] != index) {
+                last_source[edge] = index;
+                incoming[edge]++;
+            }
+        }
+    }
+    initVec(last_source, count, -1);
+
+    struct Candidate {
+        int incoming;
+        ut64 entry;
+        int index;
+        int parent;
+    };
+    auto worse = [](const Candidate & a, const Candidate & b) {
+        if (a.incoming != b.incoming) {
+            return a.incoming > b.incoming;
+        }
+        return a.entry > b.entry;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(worse)> candidates(worse);
+
+    std::vector<bool> visited;
+    initVec(visited, count, false);
+    visited[root] = true;
+    std::queue<int> queue;
+    queue.push(root);
+
+    while (true) {
+        if (isCancelled(cancelled)) {
+            return false;
+        }
+
+        // Pick nodes with single entrypoints
+        while (!queue.empty()) {
+            int index = queue.front();
+            queue.pop();
+            block_order.push_back(index);
+            for (int i = exit_start[index]; i < exit_start[index + 1]; i++) {
+                int edge = exit_index[i];
+                // Skip edge if we already visited it
+                if (visited[edge] || last_source[edge] == index) {
+                    continue;
+                }
+                last_source[edge] = index;
+
+                // If this node has no other incoming edges, add it to the graph layout
+                incoming[edge]--;
+                if (incoming[edge] == 0) {
+                    nodes[index]->new_exits.push_back(edge);
+                    queue.push(edge);
+                    visited[edge] = true;
+                } else {
+                    // Entries with an outdated count are dropped when popped
+                    candidates.push({incoming[edge], nodes[edge]->entry, edge, index});
+                }
+            }
+        }
+
+        // No more nodes satisfy constraints, pick a node to continue constructing the graph
+        while (!candidates.empty() && (visited[candidates.top().index]
+                                       || candidates.top().incoming != incoming[candidates.top().index])) {
+            candidates.pop();
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        Candidate best = candidates.top();
+        candidates.pop();
+        nodes[best.parent]->new_exits.push_back(best.index);
+        visited[best.index] = true;
+        queue.push(best.index);
+    }
+    return true;
+}
+
+// Prepare graph
+// This computes the position and (row/col based) size of every block of the spanning tree.
+// Children are laid out before their parents, shifting a subtree is recorded in
+// shift_col/shift_row and applied once at the end instead of walking the subtree each time.
+void GraphLayout::computeGraphLayout(int root)
+{
+    initVec(shift_col, nodes.size(), 0);
+    initVec(shift_row, nodes.size(), 0);
+
+    // Parents come before their children in order
+    std::vector<int> order;
+    std::vector<int> stack;
+    stack.push_back(root);
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+        order.push_back(index);
+        for (int child : nodes[index]->new_exits) {
+            stack.push_back(child);
+        }
+    }
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        computeBlockLayout(*it);
+    }
+
+    for (int index : order) {
+        Block &block = *nodes[index];
+        for (int child : block.new_exits) {
+            shift_col[child] += shift_col[index];
+            shift_row[child] += shift_row[index];
+        }
+        block.col += shift_col[index];
+        block.row += shift_row[index];
+    }
+}
+
+// Places a block relative to its children, which were placed already
+void GraphLayout::computeBlockLayout(int index)
+{
+    Block &block = *nodes[index];
+    // Column of a child including the shifts applied to it by this block so far
+    auto childCol = [this](int child) {
+        return nodes[child]->col + shift_col[child];
+    };
+
+    int col = 0;
+    int row_count = 1;
+    int childColumn = 0;
+    bool singleChild = block.new_exits.size() == 1;
+    for (int child : block.new_exits) {
+        Block &edgeb = *nodes[child];
+        row_count = std::max(edgeb.row_count + 1, row_count);
+        childColumn = edgeb.col;
+    }
+
+    if (config.layoutType != LayoutType::Wide && block.new_exits.size() == 2) {
+        int leftIndex = block.new_exits[0];
+        int rightIndex = block.new_exits[1];
+        Block &left = *nodes[leftIndex];
+        Block &right = *nodes[rightIndex];
+        if (left.new_exits.size() == 0) {
+            left.col = right.col - 2;
+            int add = left.col < 0 ? - left.col : 0;
+            adjustGraphLayout(rightIndex, add, 1);
+            adjustGraphLayout(leftIndex, add, 1);
+            col = right.col_count + add;
+        } else if (right.new_exits.size() == 0) {
+            adjustGraphLayout(leftIndex, 0, 1);
+            adjustGraphLayout(rightIndex, childCol(leftIndex) + 2, 1);
+            col = std::max(left.col_count, childCol(rightIndex) + 2);
+        } else {
+            adjustGraphLayout(leftIndex, 0, 1);
+            adjustGraphLayout(rightIndex, left.col_count, 1);
+            col = left.col_count + right.col_count;
+        }
+        block.col_count = std::max(2, col);
+        if (config.layoutType == LayoutType::Medium) {
+            block.col = (childCol(leftIndex) + childCol(rightIndex)) / 2;
+        } else {
+            block.col = singleChild ? childColumn : (col - 2) / 2;
+        }
+    } else {
+        for (int child : block.new_exits) {
+            adjustGraphLayout(child, col, 1);
+            col += nodes[child]->col_count;
+        }
+        if (col >= 2) {
+            // Place this node centered over the child nodes
+            block.col = singleChild ? childColumn : (col - 2) / 2;
+            block.col_count = col;
+        } else {
+            //No child nodes, set single node's width (nodes are 2 columns wide to allow
+            //centering over a branch)
+            block.col = 0;
+            block.col_count = 2;
+        }
+    }
+    block.row = 0;
+    block.row_count = row_count;
+}
+
+void GraphLayout::adjustGraphLayout(int index, int col, int row)
+{
+    shift_col[index] += col;
+    shift_row[index] += row;
+}
+
+// Layered placement: back edges found by a DFS are reversed, every block is put in the
+// row of its longest path from a source and a few barycenter sweeps reduce crossings.
+bool GraphLayout::computeLayeredLayout(int root, std::vector<int> &block_order, int &row_count,
+                                       int &col_count, const QAtomicInt *cancelled)
+{
+    int count = int(nodes.size());
+
+    // DFS from the entry first, then from blocks it does not reach.
+    // Edges to blocks on the DFS stack close a loop and point upwards.
+    enum { Unseen, Active, Done };
+    std::vector<int> state;
+    initVec(state, count, int(Unseen));
+    std::vector<bool> backEdge;
+    initVec(backEdge, exit_index.size(), false);
+    std::vector<std::pair<int, int>> stack;
+    for (int n = 0; n <= count; n++) {
+        int start = n == 0 ? root : n - 1;
+        if (state[start] != Unseen) {
+            continue;
+        }
+        state[start] = Active;
+        block_order.push_back(start);
+        stack.push_back(std::make_pair(start, exit_start[start]));
+        while (!stack.empty()) {
+            int index = stack.back().first;
+            int &next = stack.back().second;
+            if (next == exit_start[index + 1]) {
+                state[index] = Done;
+                stack.pop_back();
+                continue;
+            }
+            int i = next++;
+            int edge = exit_index[i];
+            if (state[edge] == Active) {
+                backEdge[i] = true;
+            } else if (state[edge] == Unseen) {
+                state[edge] = Active;
+                block_order.push_back(edge);
+                stack.push_back(std::make_pair(edge, exit_start[edge]));
+            }
+        }
+    }
+    if (isCancelled(cancelled)) {
+        return false;
+    }
+
+    // Acyclic adjacency in both directions, self loops are dropped
+    std::vector<std::vector<int>> succs(count), preds(count);
+    for (int index = 0; index < count; index++) {
+        for (int i = exit_start[index]; i < exit_start[index + 1]; i++) {
+            int edge = exit_index[i];
+            if (edge == index) {
+                continue;
+            }
+            int from = backEdge[i] ? edge : index;
+            int to = backEdge[i] ? index : edge;
+            succs[from].push_back(to);
+            preds[to].push_back(from);
+        }
+    }
+
+    // Longest path layering in topological order
+    std::vector<int> layer, remaining;
+    initVec(layer, count, 0);
+    initVec(remaining, count, 0);
+    std::vector<int> topo;
+    topo.reserve(count);
+    for (int index = 0; index < count; index++) {
+        remaining[index] = int(preds[index].size());
+        if (!remaining[index]) {
+            topo.push_back(index);
+        }
+    }
+    for (size_t t = 0; t < topo.size(); t++) {
+        int index = topo[t];
+        for (int succ : succs[index]) {
+            layer[succ] = std::max(layer[succ], layer[index] + 1);
+            if (--remaining[succ] == 0) {
+                topo.push_back(succ);
+            }
+        }
+    }
+    row_count = 0;
+    for (int index = 0; index < count; index++) {
+        row_count = std::max(row_count, layer[index] + 1);
+    }
+
+    // Initial order inside each layer follows the DFS
+    std::vector<std::vector<int>> layers(row_count);
+    for (int index : block_order) {
+        layers[layer[index]].push_back(index);
+    }
+    std::vector<double> position, barycenter;
+    initVec(position, count, 0.0);
+    initVec(barycenter, count, 0.0);
+    auto updatePositions = [&](const std::vector<int> &row) {
+        for (size_t i = 0; i < row.size(); i++) {
+            position[row[i]] = double(i);
+        }
+    };
+    for (auto &row : layers) {
+        updatePositions(row);
+    }
+
+    // Reorders a layer by the mean position of its neighbours, blocks without any keep theirs
+    auto sortLayer = [&](std::vector<int> &row, const std::vector<std::vector<int>> &neighbours) {
+        for (int index : row) {
+            const std::vector<int> &adjacent = neighbours[index];
+            if (adjacent.empty()) {
+                barycenter[index] = position[index];
+                continue;
+            }
+            double sum = 0.0;
+            for (int other : adjacent) {
+                sum += position[other];
+            }
+            barycenter[index] = sum / adjacent.size();
+        }
+        std::stable_sort(row.begin(), row.end(), [&barycenter](int a, int b) {
+            return barycenter[a] < barycenter[b];
+        });
+        updatePositions(row);
+    };
+    for (int sweep = 0; sweep < LAYERED_SWEEPS; sweep++) {
+        if (isCancelled(cancelled)) {
+            return false;
+        }
+        for (int row = 1; row < row_count; row++) {
+            sortLayer(layers[row], preds);
+        }
+        for (int row = row_count - 2; row >= 0; row--) {
+            sortLayer(layers[row], succs);
+        }
+    }
+
+    // Blocks are two columns wide, narrower layers are centered
+    size_t widest = 0;
+    for (auto &row : layers) {
+        widest = std::max(widest, row.size());
+    }
+    col_count = int(widest) * 2;
+    for (int row = 0; row < row_count; row++) {
+        int offset = int(widest - layers[row].size());
+        for (size_t i = 0; i < layers[row].size(); i++) {
+            Block &block = *nodes[layers[row][i]];
+            block.row = row;
+            block.col = offset + int(i) * 2;
+        }
+    }
+
+    return true;
+}
+
+// Edge computing stuff
+void GraphLayout::LaneGrid::reset(int lines, int cells)
+{
+    this->lines = lines;
+    this->cells = cells;
+    words = 1;
+    bits.assign(size_t(lines) * cells, 0);
+    extents.assign(size_t(lines) * cells, 0);
+}
+
+void GraphLayout::LaneGrid::trim()
+{
+    if (bits.capacity() > MAX_KEPT_WORDS) {
+        std::vector<quint64>().swap(bits);
+        std::vector<int>().swap(extents);
+        lines = cells = words = 0;
+    }
+}
+
+void GraphLayout::LaneGrid::grow(int minWords)
+{
+    int newWords = std::max(words * 2, minWords);
+    std::vector<quint64> newBits(size_t(lines) * newWords * cells, 0);
+    for (int line = 0; line < lines; line++) {
+        std::copy(bits.begin() + size_t(line) * words * cells,
+                  bits.begin() + size_t(line + 1) * words * cells,
+                  newBits.begin() + size_t(line) * newWords * cells);
+    }
+    bits.swap(newBits);
+    words = newWords;
+}
+
+void GraphLayout::LaneGrid::mark(int line, int cell, int lane, bool used)
+{
+    if (lane >= words * 64)
+        grow(lane / 64 + 1);
+    quint64 mask = quint64(1) << (lane % 64);
+    if (used)
+        word(line, lane / 64, cell) |= mask;
+    else
+        word(line, lane / 64, cell) &= ~mask;
+    int &cellExtent = extents[size_t(line) * cells + cell];
+    cellExtent = std::max(cellExtent, lane + 1);
+}
+
+int GraphLayout::LaneGrid::takeFree(int line, int first, int last)
+{
+    int lane = words * 64;
+    for (int w = 0; w < words; w++) {
+        const quint64 *row = &word(line, w, 0);
+        quint64 used = 0;
+        for (int cell = first; cell <= last; cell++)
+            used |= row[cell];
+        if (~used) {
+            lane = w * 64 + int(qCountTrailingZeroBits(~used));
+            break;
+        }
+    }
+
+    for (int cell = first; cell <= last; cell++)
+        mark(line, cell, lane);
+    return lane;
+}
+
+bool GraphLayout::isColumnFree(int col, int min_row, int max_row) const
+{
+    if (col < 0 || col >= grid_cols)
+        return false;
+    const int *prefix = &blocked_rows[size_t(col) * (grid_rows + 1)];
+    return prefix[max_row] == prefix[min_row];
+}
+
+GraphLayout::Edge GraphLayout::routeEdge(LaneGrid &horiz_edges, LaneGrid &vert_edges,
+                                         Block &start, Block &end)
+{
+    Edge edge;
+    edge.dest = end.entry;
+
+    //Find edge index for initial outgoing line
+    int i = vert_edges.takeFree(start.col + 1, start.row + 1, start.row + 1);
+    edge.addPoint(start.row + 1, start.col + 1);
+    edge.start_index = i;
+    bool horiz = false;
+
+    //Find valid column for moving vertically to the target node
+    int min_row, max_row;
+    if (end.row < (start.row + 1)) {
+        min_row = end.row;
+        max_row = start.row + 1;
+    } else {
+        min_row = start.row + 1;
+        max_row = end.row;
+    }
+    int col = start.col + 1;
+    if (min_row != max_row) {
+        auto checkColumn = [this, min_row, max_row](int column) {
+            return isColumnFree(column, min_row, max_row);
+        };
+
+        if (!checkColumn(col)) {
+            if (checkColumn(end.col + 1)) {
+                col = end.col + 1;
+            } else {
+                int ofs = 0;
+                while (true) {
+                    col = start.col + 1 - ofs;
+                    if (checkColumn(col)) {
+                        break;
+                    }
+
+                    col = start.col + 1 + ofs;
+                    if (checkColumn(col)) {
+                        break;
+                    }
+
+                    ofs += 1;
+                }
+            }
+        }
+    }
+
+    if (col != (start.col + 1)) {
+        //Not in same column, need to generate a line for moving to the correct column
+        int min_col, max_col;
+        if (col < (start.col + 1)) {
+            min_col = col;
+            max_col = start.col + 1;
+        } else {
+            min_col = start.col + 1;
+            max_col = col;
+        }
+        int index = horiz_edges.takeFree(start.row + 1, min_col, max_col);
+        edge.addPoint(start.row + 1, col, index);
+        horiz = true;
+    }
+
+    if (end.row != (start.row + 1)) {
+        //Not in same row, need to generate a line for moving to the correct row
+        if (col == (start.col + 1))
+            vert_edges.mark(start.col + 1, start.row + 1, i, false);
+        int index = vert_edges.takeFree(col, min_row, max_row);
+        if (col == (start.col + 1))
+            edge.start_index = index;
+        edge.addPoint(end.row, col, index);
+        horiz = false;
+    }
+
+    if (col != (end.col + 1)) {
+        //Not in ending column, need to generate a line for moving to the correct column
+        int min_col, max_col;
+        if (col < (end.col + 1)) {
+            min_col = col;
+            max_col = end.col + 1;
+        } else {
+            min_col = end.col + 1;
+            max_col = col;
+        }
+        int index = horiz_edges.takeFree(end.row, min_col, max_col);
+        edge.addPoint(end.row, end.col + 1, index);
+        horiz = true;
+    }
+
+    //If last line was horizontal, choose the ending edge index for the incoming edge
+    if (horiz) {
+        int index = vert_edges.takeFree(end.col + 1, end.row, end.row);
+        edge.points[int(edge.points.size()) - 1].index = index;
+    }
+
+    return edge;
+}
+
+
+
+GraphLayoutJob::GraphLayoutJob(GraphLayout *layout, ut64 entry)
+    : layout(layout),
+      entry(entry),
+      cancelled(0)
+{
+    setAutoDelete(false);
+}
+
+GraphLayoutJob::~GraphLayoutJob()
+{
+    delete layout;
+}
+
+void GraphLayoutJob::run()
+{
+    bool success = layout->compute(entry, &cancelled);
+    emit finished(success);
+}
+
+void GraphLayoutJob::cancel()
+{
+    cancelled.store(1);
+}
+
+bool GraphLayoutJob::isCancelled() const
+{
+    return cancelled.load();
+}
+
+GraphLayout *GraphLayoutJob::takeLayout()
+{
+    GraphLayout *result = layout;
+    layout = nullptr;
+    return result;
+}
@@ -0,0 +1,221 @@
+#ifndef GRAPHLAYOUT_H
+#define GRAPHLAYOUT_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QPolygonF>
+
+#include <unordered_map>
+#include <vector>
+
+#include "Cutter.h"
+
+/*!
+ * \brief Computes block positions and edge routes of a graph.
+ *
+ * Plain data structure without any dependency on widgets, so it can be run
+ * on a worker thread or without any view at all (export, benchmarks).
+ * Fill it with addBlock(), call compute() and read back getBlocks().
+ */
+class GraphLayout
+{
+public:
+    enum class LayoutType {
+        Medium,
+        Wide,
+        Narrow,
+        // Layered (Sugiyama-style) placement instead of the spanning tree
+        Layered,
+    };
+
+    struct Config {
+        // The vertical margin between blocks
+        int block_vertical_margin = 20;
+        int block_horizontal_margin = 10;
+        LayoutType layoutType = LayoutType::Medium;
+    };
+
+    struct Point {
+        int row; //point[0]
+        int col; //point[1]
+        int index; //point[2]
+    };
+
+    struct Edge {
+        ut64 dest;
+        std::vector<Point> points;
+        int start_index = 0;
+
+        QPolygonF polyline;
+        QPolygonF arrow_start;
+        QPolygonF arrow_end;
+
+        void addPoint(int row, int col, int index = 0)
+        {
+            Point point = {row, col, 0};
+            this->points.push_back(point);
+            if (int(this->points.size()) > 1)
+                this->points[this->points.size() - 2].index = index;
+        }
+    };
+
+    struct Block {
+        // Input
+        ut64 entry;
+        int width = 0;
+        int height = 0;
+        // Outgoing edges
+        std::vector<ut64> exits;
+
+        // Output
+        qreal x = 0.0;
+        qreal y = 0.0;
+        std::vector<Edge> edges;
+
+        // Layout state
+        // Outgoing edges of the spanning tree used for placement, as block indices
+        std::vector<int> new_exits;
+        // Number of rows in block
+        int row_count = 0;
+        // Number of columns in block
+        int col_count = 0;
+        // Column in which the block is
+        int col = 0;
+        // Row in which the block is
+        int row = 0;
+    };
+
+    GraphLayout();
+    explicit GraphLayout(const Config &config);
+
+    void addBlock(ut64 entry, int width, int height, const std::vector<ut64> &exits);
+
+    /*!
+     * \brief Lay out the graph starting at block entry
+     * \param cancelled if set and becoming non-zero, the computation is aborted
+     * \return false if the computation was cancelled
+     */
+    bool compute(ut64 entry, const QAtomicInt *cancelled = nullptr);
+
+    const std::unordered_map<ut64, Block> &getBlocks() const
+    {
+        return blocks;
+    }
+
+    int getWidth() const
+    {
+        return width;
+    }
+
+    int getHeight() const
+    {
+        return height;
+    }
+
+private:
+    Config config;
+    std::unordered_map<ut64, Block> blocks;
+    int width = 0;
+    int height = 0;
+
+    // Dense view of blocks used during compute(), sorted by entry.
+    // Exits of nodes[i] are exit_index[exit_start[i]] .. exit_index[exit_start[i + 1] - 1]
+    std::vector<Block *> nodes;
+    std::vector<int> exit_start;
+    std::vector<int> exit_index;
+    void buildNodes();
+
+    // Spanning tree placement
+    std::vector<int> shift_col;
+    std::vector<int> shift_row;
+    bool extractTree(int root, std::vector<int> &block_order, const QAtomicInt *cancelled);
+    void computeGraphLayout(int root);
+    void computeBlockLayout(int index);
+    void adjustGraphLayout(int index, int col, int row);
+
+    // Layered placement
+    static const int LAYERED_SWEEPS = 4;
+    bool computeLayeredLayout(int root, std::vector<int> &block_order, int &row_count,
+                              int &col_count, const QAtomicInt *cancelled);
+
+    /*!
+     * \brief Edge lanes taken in every cell of a routing grid
+     *
+     * A grid is a set of lines (rows for horizontal edges, columns for vertical ones)
+     * split into cells. Lanes of a cell are bits, stored as [line][word][cell] in one
+     * flat array so the cells of a line can be combined a word at a time.
+     */
+    class LaneGrid
+    {
+    public:
+        void reset(int lines, int cells);
+        // Frees the memory if a huge graph left it oversized
+        void trim();
+        void mark(int line, int cell, int lane, bool used = true);
+        // Lowest lane free in all cells first..last of line, marked as used in all of them
+        int takeFree(int line, int first, int last);
+        // Highest lane ever marked in the cell + 1
+        int extent(int line, int cell) const
+        {
+            return extents[size_t(line) * cells + cell];
+        }
+
+    private:
+        static const size_t MAX_KEPT_WORDS = 1 << 22;
+        int lines = 0;
+        int cells = 0;
+        int words = 0;
+        std::vector<quint64> bits;
+        std::vector<int> extents;
+
+        quint64 &word(int line, int w, int cell)
+        {
+            return bits[(size_t(line) * words + w) * cells + cell];
+        }
+        void grow(int minWords);
+    };
+
+    // Edge computing stuff
+    std::vector<int> col_edge_x;
+    std::vector<int> row_edge_y;
+    // Number of blocks in rows < r of grid column c at blocked_rows[c * (grid_rows + 1) + r]
+    std::vector<int> blocked_rows;
+    int grid_rows = 0;
+    int grid_cols = 0;
+    bool isColumnFree(int col, int min_row, int max_row) const;
+    Edge routeEdge(LaneGrid &horiz_edges, LaneGrid &vert_edges, Block &start, Block &end);
+};
+
+/*!
+ * \brief Runs a GraphLayout on a QThreadPool
+ *
+ * finished() is emitted from the worker thread, connect to it with a receiver
+ * living in the GUI thread to get the result there.
+ */
+class GraphLayoutJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    // Takes ownership of layout
+    GraphLayoutJob(GraphLayout *layout, ut64 entry);
+    ~GraphLayoutJob();
+
+    void run() override;
+    void cancel();
+    bool isCancelled() const;
+
+    // Transfers ownership of the computed layout to the caller
+    GraphLayout *takeLayout();
+
+signals:
+    void finished(bool success);
+
+private:
+    GraphLayout *layout;
+    ut64 entry;
+    QAtomicInt cancelled;
+};
+
+#endif // GRAPHLAYOUT_H
@@ -0,0 +1,111 @@
+#include "GraphSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Upper bound of grid cells per indexed item, keeps sparse graphs from allocating huge grids
+static const int MAX_CELLS_PER_ITEM = 4;
+static const qreal MIN_CELL_SIZE = 64.0;
+
+// Inclusive test, unlike QRectF::intersects() this also matches zero sized rects (points)
+static bool overlaps(const QRectF &a, const QRectF &b)
+{
+    return a.left() <= b.right() && b.left() <= a.right()
+           && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+void GraphSpatialIndex::clear()
+{
+    rects.clear();
+    cells.clear();
+    visited.clear();
+    bounds = QRectF();
+    cols = rows = 0;
+}
+
+void GraphSpatialIndex::build(const std::vector<QRectF> &itemRects)
+{
+    clear();
+    rects = itemRects;
+    if (rects.empty()) {
+        return;
+    }
+
+    qreal sizeSum = 0.0;
+    bounds = rects[0];
+    for (const QRectF &rect : rects) {
+        bounds = bounds.united(rect);
+        sizeSum += (rect.width() + rect.height()) / 2.0;
+    }
+
+    // Cells about the size of an average item
+    cellSize = std::max(MIN_CELL_SIZE, sizeSum / rects.size());
+    qreal maxCells = qreal(rects.size()) * MAX_CELLS_PER_ITEM;
+    qreal cellCount = std::ceil(bounds.width() / cellSize) * std::ceil(bounds.height() / cellSize);
+    if (cellCount > maxCells) {
+        cellSize *= std::sqrt(cellCount / maxCells);
+    }
+    cols = std::max(1, int(std::ceil(bounds.width() / cellSize)));
+    rows = std::max(1, int(std::ceil(bounds.height() / cellSize)));
+    cells.resize(size_t(cols) * rows);
+
+    for (int i = 0; i < int(rects.size()); i++) {
+        const QRectF &rect = rects[i];
+        int minCol = cellColumn(rect.left());
+        int maxCol = cellColumn(rect.right());
+        int minRow = cellRow(rect.top());
+        int maxRow = cellRow(rect.bottom());
+        for (int row = minRow; row <= maxRow; row++) {
+            for (int col = minCol; col <= maxCol; col++) {
+                cells[size_t(row) * cols + col].push_back(i);
+            }
+        }
+    }
+    visited.assign(rects.size(), 0);
+    queryId = 0;
+}
+
+void GraphSpatialIndex::query(const QRectF &rect, std::vector<int> &result) const
+{
+    result.clear();
+    if (rects.empty() || !overlaps(rect, bounds)) {
+        return;
+    }
+
+    if (++queryId == 0) {
+        // Wrapped around, forget all previous queries
+        std::fill(visited.begin(), visited.end(), 0);
+        queryId = 1;
+    }
+
+    int minCol = cellColumn(rect.left());
+    int maxCol = cellColumn(rect.right());
+    int minRow = cellRow(rect.top());
+    int maxRow = cellRow(rect.bottom());
+    for (int row = minRow; row <= maxRow; row++) {
+        for (int col = minCol; col <= maxCol; col++) {
+            for (int item : cells[size_t(row) * cols + col]) {
+                if (visited[item] == queryId) {
+                    continue;
+                }
+                visited[item] = queryId;
+                if (overlaps(rects[item], rect)) {
+                    result.push_back(item);
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+int GraphSpatialIndex::cellColumn(qreal x) const
+{
+    int col = int((x - bounds.left()) / cellSize);
+    return std::max(0, std::min(cols - 1, col));
+}
+
+int GraphSpatialIndex::cellRow(qreal y) const
+{
+    int row = int((y - bounds.top()) / cellSize);
+    return std::max(0, std::min(rows - 1, row));
+}
@@ -0,0 +1,41 @@
+#ifndef GRAPHSPATIALINDEX_H
+#define GRAPHSPATIALINDEX_H
+
+#include <QRectF>
+
+#include <vector>
+
+/*!
+ * \brief Uniform grid over the bounding rectangles of graph items
+ *
+ * Items are identified by their index in the vector passed to build().
+ * Queries only touch the grid cells overlapping the requested area.
+ */
+class GraphSpatialIndex
+{
+public:
+    void clear();
+    void build(const std::vector<QRectF> &itemRects);
+
+    /*!
+     * \brief Indices of all items whose rectangle intersects rect, in ascending order
+     */
+    void query(const QRectF &rect, std::vector<int> &result) const;
+
+private:
+    std::vector<QRectF> rects;
+    std::vector<std::vector<int>> cells;
+    QRectF bounds;
+    qreal cellSize = 1.0;
+    int cols = 0;
+    int rows = 0;
+
+    // Used to report items spanning several cells only once per query
+    mutable std::vector<unsigned int> visited;
+    mutable unsigned int queryId = 0;
+
+    int cellColumn(qreal x) const;
+    int cellRow(qreal y) const;
+};
+
+#endif // GRAPHSPATIALINDEX_H
@@ -4,11 +4,41 @@
 #include <QPainter>
 #include <QMouseEvent>
 #include <QPropertyAnimation>
+#include <QThreadPool>
 
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+
+// Maximum number of cached blocks over all cached layouts
+static const int LAYOUT_CACHE_MAX_BLOCKS = 50000;
+
+// Minimum on-screen text height in pixels for each level of detail
+static const qreal DETAIL_FULL_MIN_GLYPH = 6.0;
+static const qreal DETAIL_MNEMONIC_MIN_GLYPH = 4.0;
+static const qreal DETAIL_OUTLINE_MIN_GLYPH = 2.0;
+
+// Size of the longer side of the minimap and its distance to the viewport corner
+static const int MINIMAP_MAX_SIZE = 200;
+static const int MINIMAP_MIN_SIZE = 16;
+static const int MINIMAP_MARGIN = 10;
+
+// Tiles are only used when zoomed out, close up few blocks are visible anyway
+static const qreal TILE_MAX_SCALE = 1.0;
+// Coarser levels tried in place of a missing tile
+static const int TILE_FALLBACK_LEVELS = 3;
+static const int TILE_CACHE_MAX_KB = 64 * 1024;
+static const int TILE_RENDER_BUDGET_MS = 12;
 
 GraphView::GraphView(QWidget *parent)
-    : QAbstractScrollArea(parent)
+    : QAbstractScrollArea(parent),
+      layoutCache(LAYOUT_CACHE_MAX_BLOCKS),
+      tileCache(TILE_CACHE_MAX_KB)
 {
+    tileTimer.setSingleShot(true);
+    tileTimer.setInterval(0);
+    connect(&tileTimer, &QTimer::timeout, this, &GraphView::renderMissingTiles);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     horizontalScrollBar()->setSingleStep(charWidth);
@@ -20,21 +50,7 @@ GraphView::GraphView(QWidget *parent)
 GraphView::~GraphView()
 {
     // TODO: Cleanups
-}
-
-// Vector functions
-template<class T>
-static void removeFromVec(std::vector<T> &vec, T elem)
-{
-    vec.erase(std::remove(vec.begin(), vec.end(), elem), vec.end());
-}
-
-template<class T>
-static void initVec(std::vector<T> &vec, size_t size, T value)
-{
-    vec.resize(size);
-    for (size_t i = 0; i < size; i++)
-        vec[i] = value;
+    cancelLayoutJob();
 }
 
 // Callbacks
@@ -70,20 +86,20 @@ void GraphView::blockHelpEvent(GraphView::GraphBlock &block, QHelpEvent *event,
 
 bool GraphView::helpEvent(QHelpEvent *event)
 {
+    if (!ready || (minimapShown() && minimapRect().contains(event->pos()))) {
+        return false;
+    }
+
     int x = ((event->pos().x() - unscrolled_render_offset_x) / current_scale) +
             horizontalScrollBar()->value();
     int y = ((event->pos().y() - unscrolled_render_offset_y) / current_scale) +
             verticalScrollBar()->value();
 
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-
-        if ((block.x <= x) && (block.y <= y) &&
-                (x <= block.x + block.width) & (y <= block.y + block.height)) {
-            QPoint pos = QPoint(x - block.x, y - block.y);
-            blockHelpEvent(block, event, pos);
-            return true;
-        }
+    GraphBlock *block = blockAt(x, y);
+    if (block) {
+        QPoint pos = QPoint(x - block->x, y - block->y);
+        blockHelpEvent(*block, event, pos);
+        return true;
     }
 
     return false;
@@ -105,6 +121,37 @@ GraphView::EdgeConfiguration GraphView::edgeConfiguration(GraphView::GraphBlock
     return ec;
 }
 
+GraphView::DetailLevel GraphView::detailLevel() const
+{
+    qreal glyph = glyph_height * current_scale;
+    if (glyph >= DETAIL_FULL_MIN_GLYPH) {
+        return DetailLevel::Full;
+    } else if (glyph >= DETAIL_MNEMONIC_MIN_GLYPH) {
+        return DetailLevel::Mnemonic;
+    } else if (glyph >= DETAIL_OUTLINE_MIN_GLYPH) {
+        return DetailLevel::Outline;
+    }
+    return DetailLevel::Shape;
+}
+
+// Drop points closer than min_distance to the last kept one, the end points are always kept
+static QPolygonF simplifyPolyline(const QPolygonF &polyline, qreal min_distance)
+{
+    if (polyline.size() <= 2) {
+        return polyline;
+    }
+    QPolygonF result;
+    result.append(polyline.first());
+    for (int i = 1; i < polyline.size() - 1; i++) {
+        QPointF delta = polyline[i] - result.last();
+        if (qAbs(delta.x()) + qAbs(delta.y()) >= min_distance) {
+            result.append(polyline[i]);
+        }
+    }
+    result.append(polyline.last());
+    return result;
+}
+
 void GraphView::adjustSize(int new_width, int new_height)
 {
     double hfactor = 0.0;
@@ -137,577 +184,615 @@ bool GraphView::event(QEvent *event)
 }
 
 // This calculates the full graph starting at block entry.
+// Large graphs are laid out on a worker thread, the view shows a placeholder until then.
 void GraphView::computeGraph(ut64 entry)
 {
-    QSize areaSize = viewport()->size();
+    cancelLayoutJob();
+
+    // Reuse the previous layout if this exact graph was laid out before
+    LayoutCacheKey cacheKey(entry, layoutHash());
+    GraphLayout *cached = layoutCache.object(cacheKey);
+    if (cached && layoutMatches(*cached, entry)) {
+        applyLayout(*cached);
+        return;
+    }
 
-    // Populate incoming lists
+    GraphLayout::Config config;
+    config.block_vertical_margin = block_vertical_margin;
+    config.block_horizontal_margin = block_horizontal_margin;
+    config.layoutType = layoutType;
+    GraphLayout *layout = new GraphLayout(config);
     for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-        for (auto &edge : block.exits) {
-            blocks[edge].incoming.push_back(block.entry);
-        }
+        const GraphBlock &block = blockIt.second;
+        layout->addBlock(block.entry, block.width, block.height, block.exits);
     }
 
-    std::unordered_set<ut64> visited;
-    visited.insert(entry);
-    std::queue<ut64> queue;
-    std::vector<ut64> block_order;
-    queue.push(entry);
-
-    bool changed = true;
-    while (changed) {
-        changed = false;
-
-        // Pick nodes with single entrypoints
-        while (!queue.empty()) {
-            GraphBlock &block = blocks[queue.front()];
-            queue.pop();
-            block_order.push_back(block.entry);
-            for (ut64 edge : block.exits) {
-                // Skip edge if we already visited it
-                if (visited.count(edge)) {
-                    continue;
-                }
+    if (int(blocks.size()) < ASYNC_LAYOUT_MIN_BLOCKS) {
+        layout->compute(entry);
+        applyLayout(*layout);
+        layoutCache.insert(cacheKey, layout, int(blocks.size()) + 1);
+        return;
+    }
 
-                // Some edges might not be available
-                if (!blocks.count(edge)) {
-                    continue;
-                }
+    ready = false;
+    viewport()->update();
 
-                // If this node has no other incoming edges, add it to the graph layout
-                if (blocks[edge].incoming.size() == 1) {
-                    removeFromVec(blocks[edge].incoming, block.entry);
-                    block.new_exits.push_back(edge);
-                    queue.push(blocks[edge].entry);
-                    visited.insert(edge);
-                    changed = true;
-                } else {
-                    // Remove from incoming edges
-                    removeFromVec(blocks[edge].incoming, block.entry);
-                }
-            }
+    GraphLayoutJob *job = new GraphLayoutJob(layout, entry);
+    layoutJob = job;
+    connect(job, &GraphLayoutJob::finished, this, [this, job, cacheKey](bool success) {
+        // Superseded by a newer layout request
+        if (job != layoutJob) {
+            return;
         }
-
-        // No more nodes satisfy constraints, pick a node to continue constructing the graph
-        ut64 best = 0;
-        int best_edges;
-        ut64 best_parent;
-        for (auto &blockIt : blocks) {
-            GraphBlock &block = blockIt.second;
-            // Skip blocks we haven't visited yet
-            if (!visited.count(block.entry)) {
-                continue;
-            }
-            for (ut64 edge : block.exits) {
-                // If we already visited the exit, skip it
-                if (visited.count(edge)) {
-                    continue;
-                }
-                if (!blocks.count(edge)) {
-                    continue;
-                }
-                // find best edge
-                if ((best == 0) || ((int)blocks[edge].incoming.size() < best_edges) || (
-                            ((int)blocks[edge].incoming.size() == best_edges) && (edge < best))) {
-                    best = edge;
-                    best_edges = blocks[edge].incoming.size();
-                    best_parent = block.entry;
-                }
-            }
+        layoutJob = nullptr;
+        if (!success) {
+            return;
         }
-        if (best != 0) {
-            GraphBlock &best_parentb = blocks[best_parent];
-            removeFromVec(blocks[best].incoming, best_parentb.entry);
-            best_parentb.new_exits.push_back(best);
-            visited.insert(best);
-            queue.push(best);
-            changed = true;
+        // Blocks were replaced without requesting a new layout, lay out the current ones
+        GraphLayout *result = job->takeLayout();
+        if (this->entry != cacheKey.first || layoutHash() != cacheKey.second
+                || !layoutMatches(*result, cacheKey.first)) {
+            delete result;
+            if (blocks.empty()) {
+                // Nothing to lay out, e.g. the current function has no blocks
+                width = 0;
+                height = 0;
+                buildSpatialIndex();
+                tileCache.clear();
+                minimap_dirty = true;
+                ready = true;
+                viewport()->update();
+                return;
+            }
+            computeGraph(this->entry);
+            return;
         }
-    }
+        applyLayout(*result);
+        layoutCache.insert(cacheKey, result, int(blocks.size()) + 1);
+    });
+    // Connected after the handler above, so the job is still alive when it runs
+    connect(job, &GraphLayoutJob::finished, job, &QObject::deleteLater);
+    QThreadPool::globalInstance()->start(job);
+}
 
-    computeGraphLayout(blocks[entry]);
-
-    // Prepare edge routing
-    GraphBlock &entryb = blocks[entry];
-    EdgesVector horiz_edges, vert_edges;
-    horiz_edges.resize(entryb.row_count + 1);
-    vert_edges.resize(entryb.row_count + 1);
-    Matrix<bool> edge_valid;
-    edge_valid.resize(entryb.row_count + 1);
-    for (int row = 0; row < entryb.row_count + 1; row++) {
-        horiz_edges[row].resize(entryb.col_count + 1);
-        vert_edges[row].resize(entryb.col_count + 1);
-        initVec(edge_valid[row], entryb.col_count + 1, true);
-        for (int col = 0; col < entryb.col_count + 1; col++) {
-            horiz_edges[row][col].clear();
-            vert_edges[row][col].clear();
-        }
+void GraphView::cancelLayoutJob()
+{
+    if (layoutJob) {
+        layoutJob->cancel();
+        layoutJob = nullptr;
     }
+}
 
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-        edge_valid[block.row][block.col + 1] = false;
-    }
-
-    // Perform edge routing
-    for (ut64 block_id : block_order) {
-        GraphBlock &block = blocks[block_id];
-        GraphBlock &start = block;
-        for (ut64 edge : block.exits) {
-            GraphBlock &end = blocks[edge];
-            start.edges.push_back(routeEdge(horiz_edges, vert_edges, edge_valid, start, end, QColor(255, 0,
-                                                                                                    0)));
+// Copy the computed positions and edges into the view's blocks
+void GraphView::applyLayout(const GraphLayout &layout)
+{
+    for (auto &layoutIt : layout.getBlocks()) {
+        const GraphLayout::Block &lb = layoutIt.second;
+        auto blockIt = blocks.find(lb.entry);
+        if (blockIt == blocks.end()) {
+            // Exits to blocks which are not part of the graph get an empty placeholder block
+            GraphBlock placeholder;
+            placeholder.entry = lb.entry;
+            blockIt = blocks.insert(std::make_pair(lb.entry, placeholder)).first;
         }
-    }
-
-    // Compute edge counts for each row and column
-    std::vector<int> col_edge_count, row_edge_count;
-    initVec(col_edge_count, entryb.col_count + 1, 0);
-    initVec(row_edge_count, entryb.row_count + 1, 0);
-    for (int row = 0; row < entryb.row_count + 1; row++) {
-        for (int col = 0; col < entryb.col_count + 1; col++) {
-            if (int(horiz_edges[row][col].size()) > row_edge_count[row])
-                row_edge_count[row] = int(horiz_edges[row][col].size());
-            if (int(vert_edges[row][col].size()) > col_edge_count[col])
-                col_edge_count[col] = int(vert_edges[row][col].size());
+        blockIt->second.x = lb.x;
+        blockIt->second.y = lb.y;
+    }
+
+    for (auto &layoutIt : layout.getBlocks()) {
+        const GraphLayout::Block &lb = layoutIt.second;
+        GraphBlock &block = blocks[lb.entry];
+        block.edges.clear();
+        for (const GraphLayout::Edge &le : lb.edges) {
+            GraphEdge edge;
+            edge.dest = &blocks[le.dest];
+            edge.polyline = le.polyline;
+            edge.arrow_start = le.arrow_start;
+            edge.arrow_end = le.arrow_end;
+            // Colors are not part of the layout, they may have changed since it was computed
+            edge.color = edgeConfiguration(block, edge.dest).color;
+            block.edges.push_back(edge);
         }
     }
 
+    width = layout.getWidth();
+    height = layout.getHeight();
+    buildSpatialIndex();
+    tileCache.clear();
+    minimap_dirty = true;
+    ready = true;
 
-    //Compute row and column sizes
-    std::vector<int> col_width, row_height;
-    initVec(col_width, entryb.col_count + 1, 0);
-    initVec(row_height, entryb.row_count + 1, 0);
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-        if ((int(block.width / 2)) > col_width[block.col])
-            col_width[block.col] = int(block.width / 2);
-        if ((int(block.width / 2)) > col_width[block.col + 1])
-            col_width[block.col + 1] = int(block.width / 2);
-        if (int(block.height) > row_height[block.row])
-            row_height[block.row] = int(block.height);
-    }
-
-    // Compute row and column positions
-    std::vector<int> col_x, row_y;
-    initVec(col_x, entryb.col_count, 0);
-    initVec(row_y, entryb.row_count, 0);
-    initVec(col_edge_x, entryb.col_count + 1, 0);
-    initVec(row_edge_y, entryb.row_count + 1, 0);
-    int x = block_horizontal_margin * 2;
-    for (int i = 0; i < entryb.col_count; i++) {
-        col_edge_x[i] = x;
-        x += block_horizontal_margin * col_edge_count[i];
-        col_x[i] = x;
-        x += col_width[i];
-    }
-    int y = block_vertical_margin * 2;
-    for (int i = 0; i < entryb.row_count; i++) {
-        row_edge_y[i] = y;
-        // TODO: The 1 when row_edge_count is 0 is not needed on the original.. not sure why it's required for us
-        if (!row_edge_count[i]) {
-            row_edge_count[i] = 1;
-        }
-        y += block_vertical_margin * row_edge_count[i];
-        row_y[i] = y;
-        y += row_height[i];
-    }
-    col_edge_x[entryb.col_count] = x;
-    row_edge_y[entryb.row_count] = y;
-    width = x + (block_horizontal_margin * 2) + (block_horizontal_margin *
-                                                 col_edge_count[entryb.col_count]);
-    height = y + (block_vertical_margin * 2) + (block_vertical_margin *
-                                                row_edge_count[entryb.row_count]);
-
-    //Compute node positions
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-        block.x = int(
-                      (col_x[block.col] + col_width[block.col] + ((block_horizontal_margin / 2) * col_edge_count[block.col
-                                                                                                                 + 1])) - (block.width / 2));
-        if ((block.x + block.width) > (
-                    col_x[block.col] + col_width[block.col] + col_width[block.col + 1] + block_horizontal_margin *
-                    col_edge_count[
-                 block.col + 1])) {
-            block.x = int((col_x[block.col] + col_width[block.col] + col_width[block.col + 1] +
-                           block_horizontal_margin * col_edge_count[
-                    block.col + 1]) - block.width);
+    viewport()->update();
+    QSize areaSize = viewport()->size();
+    adjustSize(areaSize.width(), areaSize.height());
+
+    if (pending_show_block != RVA_INVALID) {
+        auto blockIt = blocks.find(pending_show_block);
+        pending_show_block = RVA_INVALID;
+        if (blockIt != blocks.end()) {
+            showBlock(blockIt->second, pending_show_animated);
         }
-        block.y = row_y[block.row];
     }
+}
 
-    // Precompute coordinates for edges
+void GraphView::buildSpatialIndex()
+{
+    std::vector<QRectF> blockRects;
+    std::vector<QRectF> edgeRects;
+    indexedBlocks.clear();
+    indexedEdges.clear();
     for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-
-        for (GraphEdge &edge : block.edges) {
-            auto start = edge.points[0];
-            auto start_col = start.col;
-            auto last_index = edge.start_index;
-            // This is the start point of the edge.
-            auto first_pt = QPoint(col_edge_x[start_col] + (block_horizontal_margin * last_index) +
-                                   (block_horizontal_margin / 2),
-                                   block.y + block.height);
-            auto last_pt = first_pt;
-            QPolygonF pts;
-            pts.append(last_pt);
-
-            for (int i = 0; i < int(edge.points.size()); i++) {
-                auto end = edge.points[i];
-                auto end_row = end.row;
-                auto end_col = end.col;
-                auto last_index = end.index;
-                QPoint new_pt;
-                // block_vertical_margin/2 gives the margin from block to the horizontal lines
-                if (start_col == end_col)
-                    new_pt = QPoint(last_pt.x(), row_edge_y[end_row] + (block_vertical_margin * last_index) +
-                                    (block_vertical_margin / 2));
-                else
-                    new_pt = QPoint(col_edge_x[end_col] + (block_horizontal_margin * last_index) +
-                                    (block_horizontal_margin / 2), last_pt.y());
-                pts.push_back(new_pt);
-                last_pt = new_pt;
-                start_col = end_col;
-            }
-
-            EdgeConfiguration ec = edgeConfiguration(block, edge.dest);
-
-            auto new_pt = QPoint(last_pt.x(), edge.dest->y - 1);
-            pts.push_back(new_pt);
-            edge.polyline = pts;
-            edge.color = ec.color;
-            if (ec.start_arrow) {
-                pts.clear();
-                pts.append(QPoint(first_pt.x() - 3, first_pt.y() + 6));
-                pts.append(QPoint(first_pt.x() + 3, first_pt.y() + 6));
-                pts.append(first_pt);
-                edge.arrow_start = pts;
-            }
-            if (ec.end_arrow) {
-                pts.clear();
-                pts.append(QPoint(new_pt.x() - 3, new_pt.y() - 6));
-                pts.append(QPoint(new_pt.x() + 3, new_pt.y() - 6));
-                pts.append(new_pt);
-                edge.arrow_end = pts;
-            }
+        const GraphBlock &block = blockIt.second;
+        indexedBlocks.push_back(block.entry);
+        // Include the shadow drawn next to the block
+        blockRects.push_back(QRectF(block.x, block.y, block.width + 8, block.height + 8));
+        for (size_t i = 0; i < block.edges.size(); i++) {
+            const GraphEdge &edge = block.edges[i];
+            QRectF rect = edge.polyline.boundingRect()
+                          .united(edge.arrow_start.boundingRect())
+                          .united(edge.arrow_end.boundingRect());
+            indexedEdges.push_back(std::make_pair(block.entry, i));
+            edgeRects.push_back(rect.adjusted(-1, -1, 1, 1));
         }
     }
+    blockIndex.build(blockRects);
+    edgeIndex.build(edgeRects);
+}
 
-    ready = true;
+GraphView::GraphBlock *GraphView::blockAt(int x, int y)
+{
+    blockIndex.query(QRectF(x, y, 0, 0), queryResult);
+    for (int item : queryResult) {
+        auto blockIt = blocks.find(indexedBlocks[item]);
+        if (blockIt == blocks.end()) {
+            continue;
+        }
+        GraphBlock &block = blockIt->second;
+        if ((block.x <= x) && (block.y <= y) &&
+                (x <= block.x + block.width) && (y <= block.y + block.height)) {
+            return &block;
+        }
+    }
+    return nullptr;
+}
 
+void GraphView::setMinimapVisible(bool visible)
+{
+    minimap_visible = visible;
     viewport()->update();
-    areaSize = viewport()->size();
-    adjustSize(areaSize.width(), areaSize.height());
 }
 
-void GraphView::paintEvent(QPaintEvent *event)
+bool GraphView::minimapShown() const
 {
-    Q_UNUSED(event);
-    QPainter p(viewport());
-    int render_offset_x = -horizontalScrollBar()->value() * current_scale;
-    int render_offset_y = -verticalScrollBar()->value() * current_scale;
-    int render_width = viewport()->size().width() / current_scale;
-    int render_height = viewport()->size().height() / current_scale;
+    if (!minimap_visible || !ready || width <= 0 || height <= 0) {
+        return false;
+    }
+    QSize area = viewport()->size();
+    // Nothing to navigate if the whole graph is visible, and small views need all their space
+    if (width * current_scale <= area.width() && height * current_scale <= area.height()) {
+        return false;
+    }
+    return area.width() >= 3 * MINIMAP_MAX_SIZE && area.height() >= 2 * MINIMAP_MAX_SIZE;
+}
 
-    // Do we have scrollbars?
-    bool hscrollbar = horizontalScrollBar()->pageStep() < width;
-    bool vscrollbar = verticalScrollBar()->pageStep() < height;
+QRect GraphView::minimapRect() const
+{
+    qreal scale = qMin(qreal(MINIMAP_MAX_SIZE) / width, qreal(MINIMAP_MAX_SIZE) / height);
+    // Very narrow graphs are stretched a bit so the minimap stays clickable
+    QSize size(qMax(MINIMAP_MIN_SIZE, qRound(width * scale)),
+               qMax(MINIMAP_MIN_SIZE, qRound(height * scale)));
+    QSize area = viewport()->size();
+    return QRect(QPoint(area.width() - size.width() - MINIMAP_MARGIN,
+                        area.height() - size.height() - MINIMAP_MARGIN), size);
+}
 
-    // Draw background
-    QRect viewportRect(viewport()->rect().topLeft(), viewport()->rect().bottomRight() - QPoint(1, 1));
-    p.setBrush(backgroundColor);
-    p.drawRect(viewportRect);
-    p.setBrush(Qt::black);
+void GraphView::renderMinimap(const QSize &size)
+{
+    qreal dpr = devicePixelRatioF();
+    minimap_image = QImage(size * dpr, QImage::Format_ARGB32_Premultiplied);
+    minimap_image.setDevicePixelRatio(dpr);
+    QColor background = backgroundColor;
+    background.setAlpha(224);
+    minimap_image.fill(background);
+    minimap_dirty = false;
 
-    unscrolled_render_offset_x = 0;
-    unscrolled_render_offset_y = 0;
+    qreal scale_x = qreal(size.width()) / width;
+    qreal scale_y = qreal(size.height()) / height;
+    QPainter p(&minimap_image);
+    p.scale(scale_x, scale_y);
 
-    // We do not have a scrollbar on this axis, so we center the view
-    if (!hscrollbar) {
-        unscrolled_render_offset_x = (viewport()->size().width() - (width * current_scale)) / 2;
-        render_offset_x += unscrolled_render_offset_x;
+    // Cosmetic pens, so even blocks and edges smaller than a pixel stay visible
+    qreal min_distance = 1.0 / qMin(scale_x, scale_y);
+    for (auto &blockIt : blocks) {
+        for (const GraphEdge &edge : blockIt.second.edges) {
+            p.setPen(QPen(edge.color, 0));
+            p.drawPolyline(simplifyPolyline(edge.polyline, min_distance));
+        }
     }
-    if (!vscrollbar) {
-        unscrolled_render_offset_y = (viewport()->size().height() - (height * current_scale)) / 2;
-        render_offset_y += unscrolled_render_offset_y;
+    p.setPen(QPen(minimapBlockColor, 0));
+    p.setBrush(minimapBlockColor);
+    for (auto &blockIt : blocks) {
+        const GraphBlock &block = blockIt.second;
+        p.drawRect(QRectF(block.x, block.y, block.width, block.height));
     }
+}
 
-    p.translate(render_offset_x, render_offset_y);
-    p.scale(current_scale, current_scale);
+// Draws the cached minimap and the frame of the visible part, p must be in viewport coordinates
+void GraphView::drawMinimap(QPainter &p, const QRectF &visibleRect)
+{
+    QRect rect = minimapRect();
+    if (minimap_dirty || minimap_image.size() != rect.size() * devicePixelRatioF()) {
+        renderMinimap(rect.size());
+    }
+    p.drawImage(rect.topLeft(), minimap_image);
+    p.setPen(palette().color(QPalette::Mid));
+    p.setBrush(Qt::NoBrush);
+    p.drawRect(rect.adjusted(0, 0, -1, -1));
 
+    qreal scale_x = qreal(rect.width()) / width;
+    qreal scale_y = qreal(rect.height()) / height;
+    QRectF frame(rect.x() + visibleRect.x() * scale_x, rect.y() + visibleRect.y() * scale_y,
+                 visibleRect.width() * scale_x, visibleRect.height() * scale_y);
+    frame = frame.intersected(QRectF(rect));
+    QColor highlight = palette().color(QPalette::Highlight);
+    p.setPen(highlight);
+    highlight.setAlpha(48);
+    p.setBrush(highlight);
+    p.drawRect(frame);
+}
 
-    // Draw blocks
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-
-        // Check if block is visible
-        if ((block.x + block.width > -render_offset_x) ||
-                (block.y + block.height > -render_offset_y) ||
-                (-render_offset_x + render_width > block.x) ||
-                (-render_offset_y + render_height > block.y)) {
-            // Only draw block if it is visible
-            drawBlock(p, block);
-        }
+// Centers the view on the graph position under pos in the minimap
+void GraphView::scrollToMinimapPos(const QPoint &pos)
+{
+    QRect rect = minimapRect();
+    qreal x = (pos.x() - rect.x()) * qreal(width) / rect.width();
+    qreal y = (pos.y() - rect.y()) * qreal(height) / rect.height();
+    horizontalScrollBar()->setValue(int(x - viewport()->width() / current_scale / 2));
+    verticalScrollBar()->setValue(int(y - viewport()->height() / current_scale / 2));
+    viewport()->update();
+}
 
-        p.setBrush(Qt::gray);
+void GraphView::clearLayoutCache()
+{
+    layoutCache.clear();
+}
 
-        // Always draw edges
-        // TODO: Only draw edges if they are actually visible ...
-        // Draw edges
-        for (GraphEdge &edge : block.edges) {
-            EdgeConfiguration ec = edgeConfiguration(block, edge.dest);
-            QPen pen(edge.color);
-//            if(blockSelected)
-//                pen.setStyle(Qt::DashLine);
-            p.setPen(pen);
-            p.setBrush(edge.color);
-            p.drawPolyline(edge.polyline);
-            pen.setStyle(Qt::SolidLine);
-            p.setPen(pen);
-            if (ec.start_arrow) {
-                p.drawConvexPolygon(edge.arrow_start);
-            }
-            if (ec.end_arrow) {
-                p.drawConvexPolygon(edge.arrow_end);
-            }
+// Hash of everything the layout depends on: block sizes and edges.
+// The combination is order independent because the blocks map is unordered.
+uint GraphView::layoutHash() const
+{
+    uint hash = qHash(quint64(blocks.size()));
+    for (auto &blockIt : blocks) {
+        const GraphBlock &block = blockIt.second;
+        uint blockHash = qHash(quint64(block.entry));
+        blockHash = blockHash * 31 + uint(block.width);
+        blockHash = blockHash * 31 + uint(block.height);
+        for (ut64 exit : block.exits) {
+            blockHash = blockHash * 31 + qHash(quint64(exit));
         }
+        hash += blockHash;
     }
+    hash = hash * 31 + uint(block_vertical_margin);
+    hash = hash * 31 + uint(block_horizontal_margin);
+    hash = hash * 31 + uint(layoutType);
+    return hash;
 }
 
-// Prepare graph
-// This computes the position and (row/col based) size of the block
-// Recursively calls itself for each child of the GraphBlock
-void GraphView::computeGraphLayout(GraphBlock &block)
-{
-    int col = 0;
-    int row_count = 1;
-    int childColumn = 0;
-    bool singleChild = block.new_exits.size() == 1;
-    // Compute all children nodes
-    for (size_t i = 0; i < block.new_exits.size(); i++) {
-        ut64 edge = block.new_exits[i];
-        GraphBlock &edgeb = blocks[edge];
-        computeGraphLayout(edgeb);
-        row_count = std::max(edgeb.row_count + 1, row_count);
-        childColumn = edgeb.col;
-    }
-
-    if (layoutType != LayoutType::Wide && block.new_exits.size() == 2) {
-        GraphBlock &left = blocks[block.new_exits[0]];
-        GraphBlock &right = blocks[block.new_exits[1]];
-        if (left.new_exits.size() == 0) {
-            left.col = right.col - 2;
-            int add = left.col < 0 ? - left.col : 0;
-            adjustGraphLayout(right, add, 1);
-            adjustGraphLayout(left, add, 1);
-            col = right.col_count + add;
-        } else if (right.new_exits.size() == 0) {
-            adjustGraphLayout(left, 0, 1);
-            adjustGraphLayout(right, left.col + 2, 1);
-            col = std::max(left.col_count, right.col + 2);
-        } else {
-            adjustGraphLayout(left, 0, 1);
-            adjustGraphLayout(right, left.col_count, 1);
-            col = left.col_count + right.col_count;
+// The hash may collide, so a cached layout is only used if it was computed from
+// exactly the current blocks plus the placeholders compute() adds for missing exits
+bool GraphView::layoutMatches(const GraphLayout &layout, ut64 entry) const
+{
+    const auto &layoutBlocks = layout.getBlocks();
+    std::unordered_set<ut64> missing;
+    for (auto &blockIt : blocks) {
+        const GraphBlock &block = blockIt.second;
+        auto layoutIt = layoutBlocks.find(block.entry);
+        if (layoutIt == layoutBlocks.end()) {
+            return false;
         }
-        block.col_count = std::max(2, col);
-        if (layoutType == LayoutType::Medium) {
-            block.col = (left.col + right.col) / 2;
-        } else {
-            block.col = singleChild ? childColumn : (col - 2) / 2;
+        const GraphLayout::Block &lb = layoutIt->second;
+        if (lb.width != block.width || lb.height != block.height || lb.exits != block.exits) {
+            return false;
         }
-    } else {
-        for (ut64 edge : block.new_exits) {
-            adjustGraphLayout(blocks[edge], col, 1);
-            col += blocks[edge].col_count;
+        for (ut64 exit : block.exits) {
+            if (!blocks.count(exit)) {
+                missing.insert(exit);
+            }
         }
-        if (col >= 2) {
-            // Place this node centered over the child nodes
-            block.col = singleChild ? childColumn : (col - 2) / 2;
-            block.col_count = col;
-        } else {
-            //No child nodes, set single node's width (nodes are 2 columns wide to allow
-            //centering over a branch)
-            block.col = 0;
-            block.col_count = 2;
+    }
+    if (!blocks.count(entry)) {
+        missing.insert(entry);
+    }
+    if (layoutBlocks.size() != blocks.size() + missing.size()) {
+        return false;
+    }
+    for (ut64 placeholder : missing) {
+        auto layoutIt = layoutBlocks.find(placeholder);
+        if (layoutIt == layoutBlocks.end() || layoutIt->second.width || layoutIt->second.height
+                || !layoutIt->second.exits.empty()) {
+            return false;
         }
     }
-    block.row = 0;
-    block.row_count = row_count;
+    return true;
 }
 
-// Edge computing stuff
-bool GraphView::isEdgeMarked(EdgesVector &edges, int row, int col, int index)
+bool GraphView::useTiles() const
 {
-    if (index >= int(edges[row][col].size()))
-        return false;
-    return edges[row][col][index];
+    return current_scale < TILE_MAX_SCALE;
+}
+
+// Tiles are rendered at the next power of two scale above the current one
+int GraphView::tileLevel() const
+{
+    int level = int(std::ceil(std::log2(current_scale)));
+    return level < TILE_MIN_LEVEL ? TILE_MIN_LEVEL : level;
 }
 
-void GraphView::markEdge(EdgesVector &edges, int row, int col, int index, bool used)
+quint64 GraphView::TileId::key() const
 {
-    while (int(edges[row][col].size()) <= index)
-        edges[row][col].push_back(false);
-    edges[row][col][index] = used;
+    return (quint64(level - TILE_MIN_LEVEL) << 56) | (quint64(x) << 28) | quint64(y);
 }
 
-GraphView::GraphEdge GraphView::routeEdge(EdgesVector &horiz_edges, EdgesVector &vert_edges,
-                                          Matrix<bool> &edge_valid, GraphBlock &start, GraphBlock &end, QColor color)
+QRectF GraphView::TileId::rect() const
 {
-    GraphEdge edge;
-    edge.color = color;
-    edge.dest = &end;
+    qreal extent = TILE_SIZE / std::ldexp(1.0, level);
+    return QRectF(x * extent, y * extent, extent, extent);
+}
 
-    //Find edge index for initial outgoing line
-    int i = 0;
-    while (true) {
-        if (!isEdgeMarked(vert_edges, start.row + 1, start.col + 1, i))
-            break;
-        i += 1;
+void GraphView::invalidateTiles()
+{
+    tileCache.clear();
+    viewport()->update();
+}
+
+// Tiles intersecting rect keep being shown until their replacement is rendered
+void GraphView::invalidateTiles(const QRectF &rect)
+{
+    for (quint64 key : tileCache.keys()) {
+        TileId id;
+        id.level = int(key >> 56) + TILE_MIN_LEVEL;
+        id.x = int((key >> 28) & 0xfffffff);
+        id.y = int(key & 0xfffffff);
+        if (id.rect().intersects(rect)) {
+            tileCache.object(key)->stale = true;
+        }
     }
-    markEdge(vert_edges, start.row + 1, start.col + 1, i);
-    edge.addPoint(start.row + 1, start.col + 1);
-    edge.start_index = i;
-    bool horiz = false;
+    viewport()->update();
+}
 
-    //Find valid column for moving vertically to the target node
-    int min_row, max_row;
-    if (end.row < (start.row + 1)) {
-        min_row = end.row;
-        max_row = start.row + 1;
-    } else {
-        min_row = start.row + 1;
-        max_row = end.row;
-    }
-    int col = start.col + 1;
-    if (min_row != max_row) {
-        auto checkColumn = [min_row, max_row, &edge_valid](int column) {
-            if (column < 0 || column >= int(edge_valid[min_row].size()))
-                return false;
-            for (int row = min_row; row < max_row; row++) {
-                if (!edge_valid[row][column]) {
-                    return false;
-                }
-            }
-            return true;
-        };
-
-        if (!checkColumn(col)) {
-            if (checkColumn(end.col + 1)) {
-                col = end.col + 1;
-            } else {
-                int ofs = 0;
-                while (true) {
-                    col = start.col + 1 - ofs;
-                    if (checkColumn(col)) {
-                        break;
-                    }
-
-                    col = start.col + 1 + ofs;
-                    if (checkColumn(col)) {
-                        break;
-                    }
-
-                    ofs += 1;
+// Composites the tiles covering visibleRect, p must be in viewport coordinates
+void GraphView::drawTiles(QPainter &p, const QRectF &visibleRect)
+{
+    int level = tileLevel();
+    qreal extent = TILE_SIZE / std::ldexp(1.0, level);
+    int first_x = qMax(0, int(visibleRect.left() / extent));
+    int first_y = qMax(0, int(visibleRect.top() / extent));
+    int last_x = qMin(int(width / extent), int(visibleRect.right() / extent));
+    int last_y = qMin(int(height / extent), int(visibleRect.bottom() / extent));
+
+    p.setRenderHint(QPainter::SmoothPixmapTransform);
+    missingTiles.clear();
+    for (int y = first_y; y <= last_y; y++) {
+        for (int x = first_x; x <= last_x; x++) {
+            TileId id = { level, x, y };
+            QRectF rect = id.rect();
+            QRectF dest((rect.x() - visibleRect.x()) * current_scale,
+                        (rect.y() - visibleRect.y()) * current_scale,
+                        rect.width() * current_scale, rect.height() * current_scale);
+            Tile *tile = tileCache.object(id.key());
+            if (tile) {
+                p.drawImage(dest, tile->image);
+                if (tile->stale) {
+                    missingTiles.push_back(id);
                 }
+                continue;
             }
+            missingTiles.push_back(id);
+            drawFallbackTile(p, id, dest);
         }
     }
+    if (missingTiles.empty()) {
+        return;
+    }
 
-    if (col != (start.col + 1)) {
-        //Not in same column, need to generate a line for moving to the correct column
-        int min_col, max_col;
-        if (col < (start.col + 1)) {
-            min_col = col;
-            max_col = start.col + 1;
-        } else {
-            min_col = start.col + 1;
-            max_col = col;
-        }
-        int index = findHorizEdgeIndex(horiz_edges, start.row + 1, min_col, max_col);
-        edge.addPoint(start.row + 1, col, index);
-        horiz = true;
-    }
-
-    if (end.row != (start.row + 1)) {
-        //Not in same row, need to generate a line for moving to the correct row
-        if (col == (start.col + 1))
-            markEdge(vert_edges, start.row + 1, start.col + 1, i, false);
-        int index = findVertEdgeIndex(vert_edges, col, min_row, max_row);
-        if (col == (start.col + 1))
-            edge.start_index = index;
-        edge.addPoint(end.row, col, index);
-        horiz = false;
-    }
-
-    if (col != (end.col + 1)) {
-        //Not in ending column, need to generate a line for moving to the correct column
-        int min_col, max_col;
-        if (col < (end.col + 1)) {
-            min_col = col;
-            max_col = end.col + 1;
-        } else {
-            min_col = end.col + 1;
-            max_col = col;
+    // Render the tiles in the middle of the view first
+    QPointF center = visibleRect.center();
+    auto distance = [center](const TileId & id) {
+        QPointF delta = id.rect().center() - center;
+        return delta.x() * delta.x() + delta.y() * delta.y();
+    };
+    std::sort(missingTiles.begin(), missingTiles.end(),
+    [&distance](const TileId & a, const TileId & b) {
+        return distance(a) > distance(b);
+    });
+    if (!tileTimer.isActive()) {
+        tileTimer.start();
+    }
+}
+
+// Fills the place of a tile which is not rendered yet with a coarser or finer one
+void GraphView::drawFallbackTile(QPainter &p, const TileId &id, const QRectF &dest)
+{
+    for (int steps = 1; steps <= TILE_FALLBACK_LEVELS && id.level - steps >= TILE_MIN_LEVEL;
+            steps++) {
+        TileId coarse = { id.level - steps, id.x >> steps, id.y >> steps };
+        Tile *tile = tileCache.object(coarse.key());
+        if (!tile) {
+            continue;
         }
-        int index = findHorizEdgeIndex(horiz_edges, end.row, min_col, max_col);
-        edge.addPoint(end.row, end.col + 1, index);
-        horiz = true;
+        qreal ratio = tile->image.devicePixelRatio();
+        qreal size = qreal(TILE_SIZE >> steps) * ratio;
+        int mask = (1 << steps) - 1;
+        QRectF source((id.x & mask) * size, (id.y & mask) * size, size, size);
+        p.drawImage(dest, tile->image, source);
+        return;
     }
 
-    //If last line was horizontal, choose the ending edge index for the incoming edge
-    if (horiz) {
-        int index = findVertEdgeIndex(vert_edges, end.col + 1, end.row, end.row);
-        edge.points[int(edge.points.size()) - 1].index = index;
+    qreal half_width = dest.width() / 2;
+    qreal half_height = dest.height() / 2;
+    for (int i = 0; i < 4; i++) {
+        TileId fine = { id.level + 1, 2 * id.x + (i & 1), 2 * id.y + (i >> 1) };
+        Tile *tile = tileCache.object(fine.key());
+        if (tile) {
+            p.drawImage(QRectF(dest.x() + (i & 1) * half_width, dest.y() + (i >> 1) * half_height,
+                               half_width, half_height), tile->image);
+        }
     }
+}
 
-    return edge;
+void GraphView::renderTile(const TileId &id)
+{
+    qreal ratio = devicePixelRatioF();
+    Tile *tile = new Tile;
+    tile->image = QImage(QSize(TILE_SIZE, TILE_SIZE) * ratio, QImage::Format_ARGB32_Premultiplied);
+    tile->image.setDevicePixelRatio(ratio);
+    tile->image.fill(backgroundColor);
+
+    // Blocks pick their level of detail from the current scale, render them as if
+    // the view was zoomed to the tile's scale
+    double scale = current_scale;
+    current_scale = std::ldexp(1.0, id.level);
+    QRectF rect = id.rect();
+    QPainter p(&tile->image);
+    p.setFont(font());
+    p.scale(current_scale, current_scale);
+    p.translate(-rect.topLeft());
+    drawGraph(p, rect);
+    p.end();
+    current_scale = scale;
+
+    int cost = tile->image.width() * tile->image.height() * 4 / 1024 + 1;
+    tileCache.insert(id.key(), tile, cost);
 }
 
+// Renders missing tiles until the time budget is used up, the next paint requests the rest
+void GraphView::renderMissingTiles()
+{
+    if (!ready || !useTiles()) {
+        missingTiles.clear();
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    while (!missingTiles.empty() && timer.elapsed() < TILE_RENDER_BUDGET_MS) {
+        TileId id = missingTiles.back();
+        missingTiles.pop_back();
+        if (id.level == tileLevel()) {
+            renderTile(id);
+        }
+    }
+    viewport()->update();
+}
 
-int GraphView::findHorizEdgeIndex(EdgesVector &edges, int row, int min_col, int max_col)
+// Draws the blocks and edges intersecting rect, p must be in graph coordinates
+void GraphView::drawGraph(QPainter &p, const QRectF &rect)
 {
-    //Find a valid index
-    int i = 0;
-    while (true) {
-        bool valid = true;
-        for (int col = min_col; col < max_col + 1; col++)
-            if (isEdgeMarked(edges, row, col, i)) {
-                valid = false;
-                break;
-            }
-        if (valid)
-            break;
-        i++;
+    // Draw blocks
+    blockIndex.query(rect, queryResult);
+    for (int item : queryResult) {
+        auto blockIt = blocks.find(indexedBlocks[item]);
+        if (blockIt != blocks.end()) {
+            drawBlock(p, blockIt->second);
+        }
     }
 
-    //Mark chosen index as used
-    for (int col = min_col; col < max_col + 1; col++)
-        markEdge(edges, row, col, i);
-    return i;
+    p.setBrush(Qt::gray);
+
+    // Draw edges
+    // When zoomed out far, edges are drawn without arrows and with points closer than
+    // a pixel merged
+    bool simplifyEdges = detailLevel() >= DetailLevel::Outline;
+    edgeIndex.query(rect, queryResult);
+    for (int item : queryResult) {
+        auto blockIt = blocks.find(indexedEdges[item].first);
+        if (blockIt == blocks.end() || indexedEdges[item].second >= blockIt->second.edges.size()) {
+            continue;
+        }
+        GraphBlock &block = blockIt->second;
+        GraphEdge &edge = block.edges[indexedEdges[item].second];
+        if (simplifyEdges) {
+            QPen pen(edge.color, 0);
+            p.setPen(pen);
+            p.drawPolyline(simplifyPolyline(edge.polyline, 1.0 / current_scale));
+            continue;
+        }
+        EdgeConfiguration ec = edgeConfiguration(block, edge.dest);
+        QPen pen(edge.color);
+//        if(blockSelected)
+//            pen.setStyle(Qt::DashLine);
+        p.setPen(pen);
+        p.setBrush(edge.color);
+        p.drawPolyline(edge.polyline);
+        pen.setStyle(Qt::SolidLine);
+        p.setPen(pen);
+        if (ec.start_arrow) {
+            p.drawConvexPolygon(edge.arrow_start);
+        }
+        if (ec.end_arrow) {
+            p.drawConvexPolygon(edge.arrow_end);
+        }
+    }
 }
 
-int GraphView::findVertEdgeIndex(EdgesVector &edges, int col, int min_row, int max_row)
+void GraphView::paintEvent(QPaintEvent *event)
 {
-    //Find a valid index
-    int i = 0;
-    while (true) {
-        bool valid = true;
-        for (int row = min_row; row < max_row + 1; row++)
-            if (isEdgeMarked(edges, row, col, i)) {
-                valid = false;
-                break;
-            }
-        if (valid)
-            break;
-        i++;
+    Q_UNUSED(event);
+    QPainter p(viewport());
+    int render_offset_x = -horizontalScrollBar()->value() * current_scale;
+    int render_offset_y = -verticalScrollBar()->value() * current_scale;
+    int render_width = viewport()->size().width() / current_scale;
+    int render_height = viewport()->size().height() / current_scale;
+
+    // Do we have scrollbars?
+    bool hscrollbar = horizontalScrollBar()->pageStep() < width;
+    bool vscrollbar = verticalScrollBar()->pageStep() < height;
+
+    // Draw background
+    QRect viewportRect(viewport()->rect().topLeft(), viewport()->rect().bottomRight() - QPoint(1, 1));
+    p.setBrush(backgroundColor);
+    p.drawRect(viewportRect);
+    p.setBrush(Qt::black);
+
+    if (!ready) {
+        if (layoutJob) {
+            p.setPen(palette().color(QPalette::WindowText));
+            p.drawText(viewportRect, Qt::AlignCenter, tr("Computing graph layout..."));
+        }
+        return;
     }
 
-    //Mark chosen index as used
-    for (int row = min_row; row < max_row + 1; row++)
-        markEdge(edges, row, col, i);
-    return i;
+    unscrolled_render_offset_x = 0;
+    unscrolled_render_offset_y = 0;
+
+    // We do not have a scrollbar on this axis, so we center the view
+    if (!hscrollbar) {
+        unscrolled_render_offset_x = (viewport()->size().width() - (width * current_scale)) / 2;
+        render_offset_x += unscrolled_render_offset_x;
+    }
+    if (!vscrollbar) {
+        unscrolled_render_offset_y = (viewport()->size().height() - (height * current_scale)) / 2;
+        render_offset_y += unscrolled_render_offset_y;
+    }
+
+    p.translate(render_offset_x, render_offset_y);
+    p.scale(current_scale, current_scale);
+
+
+    // Only touch blocks and edges in the visible part of the graph
+    QRectF visibleRect(-render_offset_x / current_scale, -render_offset_y / current_scale,
+                       render_width, render_height);
+
+    if (useTiles()) {
+        p.resetTransform();
+        drawTiles(p, visibleRect);
+    } else {
+        drawGraph(p, visibleRect);
+    }
+
+    if (minimapShown()) {
+        p.resetTransform();
+        drawMinimap(p, visibleRect);
+    }
 }
 
 void GraphView::showBlock(GraphBlock &block, bool animated)
@@ -717,6 +802,13 @@ void GraphView::showBlock(GraphBlock &block, bool animated)
 
 void GraphView::showBlock(GraphBlock *block, bool animated)
 {
+    if (!ready) {
+        // Positions are not known yet, show it once the layout is done
+        pending_show_block = block->entry;
+        pending_show_animated = animated;
+        return;
+    }
+
     int render_width = viewport()->size().width() / current_scale;
 
 
@@ -753,15 +845,6 @@ void GraphView::showBlock(GraphBlock *block, bool animated)
     viewport()->update();
 }
 
-void GraphView::adjustGraphLayout(GraphBlock &block, int col, int row)
-{
-    block.col += col;
-    block.row += row;
-    for (ut64 edge : block.new_exits) {
-        adjustGraphLayout(blocks[edge], col, row);
-    }
-}
-
 void GraphView::addBlock(GraphView::GraphBlock block)
 {
     blocks[block.entry] = block;
@@ -793,29 +876,41 @@ void GraphView::resizeEvent(QResizeEvent *event)
 // Mouse events
 void GraphView::mousePressEvent(QMouseEvent *event)
 {
+    if (minimapShown() && minimapRect().contains(event->pos())) {
+        if (event->button() == Qt::LeftButton) {
+            minimap_dragging = true;
+            scrollToMinimapPos(event->pos());
+        }
+        return;
+    }
+
     int x = ((event->pos().x() - unscrolled_render_offset_x) / current_scale) +
             horizontalScrollBar()->value();
     int y = ((event->pos().y() - unscrolled_render_offset_y) / current_scale) +
             verticalScrollBar()->value();
 
-    // Check if a block was clicked
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-
-        if ((block.x <= x) && (block.y <= y) &&
-                (x <= block.x + block.width) & (y <= block.y + block.height)) {
-            QPoint pos = QPoint(x - block.x, y - block.y);
-            blockClicked(block, event, pos);
+    if (ready) {
+        // Check if a block was clicked
+        GraphBlock *block = blockAt(x, y);
+        if (block) {
+            QPoint pos = QPoint(x - block->x, y - block->y);
+            blockClicked(*block, event, pos);
             // Don't do anything else here! blockClicked might seek and
             // all our data is invalid then.
             return;
         }
-    }
 
-    // Check if a line beginning/end  was clicked
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-        for (GraphEdge &edge : block.edges) {
+        // Check if a line beginning/end  was clicked
+        // The clickable area around edge ends is at most 15 pixels away from the point
+        edgeIndex.query(QRectF(x - 16, y - 16, 32, 32), queryResult);
+        std::vector<int> edgeItems = queryResult;
+        for (int item : edgeItems) {
+            auto blockIt = blocks.find(indexedEdges[item].first);
+            if (blockIt == blocks.end() || indexedEdges[item].second >= blockIt->second.edges.size()) {
+                continue;
+            }
+            GraphBlock &block = blockIt->second;
+            GraphEdge &edge = block.edges[indexedEdges[item].second];
             if (edge.polyline.length() < 2) {
                 continue;
             }
@@ -825,13 +920,11 @@ void GraphView::mousePressEvent(QMouseEvent *event)
                 showBlock(edge.dest, true);
                 // TODO: Callback to child
                 return;
-                break;
             }
             if (checkPointClicked(end, x, y, true)) {
                 showBlock(block, true);
                 // TODO: Callback to child
                 return;
-                break;
             }
         }
     }
@@ -850,7 +943,9 @@ void GraphView::mousePressEvent(QMouseEvent *event)
 
 void GraphView::mouseMoveEvent(QMouseEvent *event)
 {
-    if (scroll_mode) {
+    if (minimap_dragging) {
+        scrollToMinimapPos(event->pos());
+    } else if (scroll_mode) {
         int x_delta = scroll_base_x - event->x();
         int y_delta = scroll_base_y - event->y();
         scroll_base_x = event->x();
@@ -862,21 +957,20 @@ void GraphView::mouseMoveEvent(QMouseEvent *event)
 
 void GraphView::mouseDoubleClickEvent(QMouseEvent *event)
 {
+    if (!ready || (minimapShown() && minimapRect().contains(event->pos()))) {
+        return;
+    }
+
     int x = ((event->pos().x() - unscrolled_render_offset_x) / current_scale) +
             horizontalScrollBar()->value();
     int y = ((event->pos().y() - unscrolled_render_offset_y) / current_scale) +
             verticalScrollBar()->value();
 
     // Check if a block was clicked
-    for (auto &blockIt : blocks) {
-        GraphBlock &block = blockIt.second;
-
-        if ((block.x <= x) && (block.y <= y) &&
-                (x <= block.x + block.width) & (y <= block.y + block.height)) {
-            QPoint pos = QPoint(x - block.x, y - block.y);
-            blockDoubleClicked(block, event, pos);
-            return;
-        }
+    GraphBlock *block = blockAt(x, y);
+    if (block) {
+        QPoint pos = QPoint(x - block->x, y - block->y);
+        blockDoubleClicked(*block, event, pos);
     }
 }
 
@@ -891,6 +985,7 @@ void GraphView::mouseReleaseEvent(QMouseEvent *event)
     if (event->button() != Qt::LeftButton)
         return;
 
+    minimap_dragging = false;
     if (scroll_mode) {
         scroll_mode = false;
         setCursor(Qt::ArrowCursor);
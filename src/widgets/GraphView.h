@@ -8,48 +8,31 @@
 #include <QScrollBar>
 #include <QElapsedTimer>
 #include <QHelpEvent>
+#include <QCache>
+#include <QImage>
+#include <QTimer>
+#include <QPair>
 
 #include <unordered_map>
-#include <unordered_set>
-#include <queue>
 
 #include "Cutter.h"
+#include "widgets/GraphLayout.h"
+#include "widgets/GraphSpatialIndex.h"
 
 class GraphView : public QAbstractScrollArea
 {
     Q_OBJECT
 
-    enum class LayoutType {
-        Medium,
-        Wide,
-        Narrow,
-    };
 public:
     struct GraphBlock;
 
-    struct Point {
-        int row; //point[0]
-        int col; //point[1]
-        int index; //point[2]
-    };
-
     struct GraphEdge {
         QColor color;
         GraphBlock *dest;
-        std::vector<Point> points;
-        int start_index = 0;
 
         QPolygonF polyline;
         QPolygonF arrow_start;
         QPolygonF arrow_end;
-
-        void addPoint(int row, int col, int index = 0)
-        {
-            Point point = {row, col, 0};
-            this->points.push_back(point);
-            if (int(this->points.size()) > 1)
-                this->points[this->points.size() - 2].index = index;
-        }
     };
 
     struct GraphBlock {
@@ -62,24 +45,23 @@ public:
         // This contains unique identifiers to entries
         // Outgoing edges
         std::vector<ut64> exits;
-        // Incoming edges
-        std::vector<ut64> incoming;
-        // TODO what is this
-        std::vector<ut64> new_exits;
-
-        // Number of rows in block
-        int row_count = 0;
-        // Number of columns in block
-        int col_count = 0;
-        // Column in which the block is
-        int col = 0;
-        // Row in which the block is
-        int row = 0;
 
         // Edges
         std::vector<GraphEdge> edges;
     };
 
+    // Level of detail blocks and edges are drawn with, see detailLevel()
+    enum class DetailLevel {
+        // All text
+        Full,
+        // Only the mnemonic of each instruction
+        Mnemonic,
+        // Solid blocks with a label
+        Outline,
+        // Only block rectangles and edges without arrows
+        Shape,
+    };
+
     struct EdgeConfiguration {
         QColor color = QColor(128, 128, 128);
         bool start_arrow = false;
@@ -94,9 +76,18 @@ public:
     void showBlock(GraphBlock &block, bool animated = false);
     void showBlock(GraphBlock *block, bool animated = false);
 
+    // Overview of the whole graph in the corner of the view, shown when the graph does not fit
+    void setMinimapVisible(bool visible);
+    bool isMinimapVisible() const
+    {
+        return minimap_visible;
+    }
+
 protected:
     std::unordered_map<ut64, GraphBlock> blocks;
     QColor backgroundColor = QColor(Qt::white);
+    // Fill of the blocks in the minimap
+    QColor minimapBlockColor = QColor(Qt::gray);
     // The vertical margin between blocks
     int block_vertical_margin = 20;
     int block_horizontal_margin = 10;
@@ -110,9 +101,20 @@ protected:
     int unscrolled_render_offset_x = 0;
     int unscrolled_render_offset_y = 0;
 
+    // Layout type
+    GraphLayout::LayoutType layoutType = GraphLayout::LayoutType::Medium;
+
+    // Height of a line of text in graph coordinates, used to pick the level of detail
+    qreal glyph_height = 12.0;
+    DetailLevel detailLevel() const;
+
     void addBlock(GraphView::GraphBlock block);
     void setEntry(ut64 e);
     void computeGraph(ut64 entry);
+    void clearLayoutCache();
+    // Drop the rendered tiles, e.g. after the look of blocks changed without a new layout
+    void invalidateTiles();
+    void invalidateTiles(const QRectF &rect);
 
     // Callbacks that should be overridden
     virtual void drawBlock(QPainter &p, GraphView::GraphBlock &block);
@@ -131,15 +133,9 @@ private:
 
     ut64 entry;
 
-    void computeGraphLayout(GraphBlock &block);
-    void adjustGraphLayout(GraphBlock &block, int col, int row);
-
-    // Layout type
-    LayoutType layoutType;
-
-    int width;
-    int height;
-    bool ready;
+    int width = 0;
+    int height = 0;
+    bool ready = false;
 
     // Scrolling data
     int scroll_base_x;
@@ -150,18 +146,78 @@ private:
     // Todo: remove charheight/charwidth cause it should be handled in child class
     qreal charWidth = 10.0;
 
-    // Edge computing stuff
-    template<typename T>
-    using Matrix = std::vector<std::vector<T>>;
-    using EdgesVector = Matrix<std::vector<bool>>;
-    std::vector<int> col_edge_x;
-    std::vector<int> row_edge_y;
-    bool isEdgeMarked(EdgesVector &edges, int row, int col, int index);
-    void markEdge(EdgesVector &edges, int row, int col, int index, bool used = true);
-    int findHorizEdgeIndex(EdgesVector &edges, int row, int min_col, int max_col);
-    int findVertEdgeIndex(EdgesVector &edges, int col, int min_row, int max_row);
-    GraphEdge routeEdge(EdgesVector &horiz_edges, EdgesVector &vert_edges, Matrix<bool> &edge_valid,
-                        GraphBlock &start, GraphBlock &end, QColor color);
+    // Layout computation
+    // Graphs with fewer blocks than this are laid out synchronously
+    static const int ASYNC_LAYOUT_MIN_BLOCKS = 256;
+    GraphLayoutJob *layoutJob = nullptr;
+    // Block to show as soon as the pending layout is ready
+    ut64 pending_show_block = RVA_INVALID;
+    bool pending_show_animated = false;
+    void cancelLayoutJob();
+    void applyLayout(const GraphLayout &layout);
+
+    // Spatial index over block and edge bounds, rebuilt with every layout
+    GraphSpatialIndex blockIndex;
+    GraphSpatialIndex edgeIndex;
+    std::vector<ut64> indexedBlocks;
+    // Source block entry and index into its edges
+    std::vector<std::pair<ut64, size_t>> indexedEdges;
+    std::vector<int> queryResult;
+    void buildSpatialIndex();
+    GraphBlock *blockAt(int x, int y);
+
+    // Layout cache
+    // Keeps the computed layouts of recently shown graphs,
+    // keyed by the entry and a hash of the block geometry and exits.
+    // A hit is only used if layoutMatches() the current blocks.
+    using LayoutCacheKey = QPair<ut64, uint>;
+    QCache<LayoutCacheKey, GraphLayout> layoutCache;
+    uint layoutHash() const;
+    bool layoutMatches(const GraphLayout &layout, ut64 entry) const;
+
+    // Minimap
+    // The graph is rendered into minimap_image once per layout,
+    // panning and zooming only move the viewport frame drawn on top of it.
+    bool minimap_visible = true;
+    bool minimap_dirty = true;
+    bool minimap_dragging = false;
+    QImage minimap_image;
+    bool minimapShown() const;
+    QRect minimapRect() const;
+    void renderMinimap(const QSize &size);
+    void drawMinimap(QPainter &p, const QRectF &visibleRect);
+    void scrollToMinimapPos(const QPoint &pos);
+
+    // Tile cache
+    // When zoomed out, the graph is composited from TILE_SIZE pixel tiles rendered at power
+    // of two scales (levels). Missing tiles are rendered a few at a time between paints,
+    // until then coarser or finer tiles which are already available are shown in their place.
+    static const int TILE_SIZE = 256;
+    static const int TILE_MIN_LEVEL = -8;
+    struct TileId {
+        int level;
+        int x;
+        int y;
+        quint64 key() const;
+        // Covered area in graph coordinates
+        QRectF rect() const;
+    };
+    struct Tile {
+        QImage image;
+        // Outdated, shown until it is rendered again
+        bool stale = false;
+    };
+    QCache<quint64, Tile> tileCache;
+    // Tiles wanted by the last paint, the next one to render last
+    std::vector<TileId> missingTiles;
+    QTimer tileTimer;
+    bool useTiles() const;
+    int tileLevel() const;
+    void drawGraph(QPainter &p, const QRectF &rect);
+    void drawTiles(QPainter &p, const QRectF &visibleRect);
+    void drawFallbackTile(QPainter &p, const TileId &id, const QRectF &dest);
+    void renderTile(const TileId &id);
+    void renderMissingTiles();
 
 private slots:
     void resizeEvent(QResizeEvent *event) override;
@@ -1,5 +1,6 @@
 #include "Omnibar.h"
 #include "MainWindow.h"
+#include "utils/NameIndex.h"
 
 #include <QStringListModel>
 #include <QCompleter>
@@ -9,7 +10,8 @@
 
 Omnibar::Omnibar(MainWindow *main, QWidget *parent) :
     QLineEdit(parent),
-    main(main)
+    main(main),
+    completionModel(new QStringListModel(this))
 {
     // QLineEdit basic features
     this->setMinimumHeight(16);
@@ -25,32 +27,120 @@ Omnibar::Omnibar(MainWindow *main, QWidget *parent) :
     QShortcut *clear_shortcut = new QShortcut(QKeySequence(Qt::Key_Escape), this);
     connect(clear_shortcut, SIGNAL(activated()), this, SLOT(clear()));
     clear_shortcut->setContext(Qt::WidgetWithChildrenShortcut);
-}
 
-void Omnibar::setupCompleter()
-{
-    // Set gotoEntry completer for jump history
-    QCompleter *completer = new QCompleter(flags, this);
+    // The model already holds the best matches for the text, the completer must not filter them
+    QCompleter *completer = new QCompleter(completionModel, this);
     completer->setMaxVisibleItems(20);
-    completer->setCompletionMode(QCompleter::PopupCompletion);
-    completer->setModelSorting(QCompleter::CaseSensitivelySortedModel);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
     completer->setCaseSensitivity(Qt::CaseInsensitive);
-    completer->setFilterMode(Qt::MatchContains);
-
     this->setCompleter(completer);
+
+    // Emitted before the line edit asks the completer to show its popup
+    connect(this, &QLineEdit::textEdited, this, &Omnibar::updateCompletions);
+
+    pool.setMaxThreadCount(1);
+
+    connect(Core(), SIGNAL(refreshAll()), this, SLOT(rebuildIndex()));
+    connect(Core(), SIGNAL(flagAdded(const QString &)), this, SLOT(addName(const QString &)));
+    connect(Core(), SIGNAL(flagRemoved(const QString &)), this, SLOT(removeName(const QString &)));
+    connect(Core(), SIGNAL(flagRenamed(const QString &, const QString &)),
+            this, SLOT(renameName(const QString &, const QString &)));
+    connect(Core(), SIGNAL(functionRenamed(const QString &, const QString &)),
+            this, SLOT(renameName(const QString &, const QString &)));
+    connect(Core(), SIGNAL(functionsChangedInRange(RVA, RVA)),
+            this, SLOT(updateFunctions(RVA, RVA)));
+}
+
+Omnibar::~Omnibar()
+{
+    pool.clear();
+    pool.waitForDone();
 }
 
-void Omnibar::refresh(const QStringList &flagList)
+void Omnibar::rebuildIndex()
 {
-    flags = flagList;
+    int generation = ++buildGeneration;
+    building = true;
+
+    // The old index keeps answering until the new one is done
+    auto builtIndex = std::make_shared<NameIndex>();
+    auto builtFunctions = std::make_shared<QMap<RVA, QString>>();
+    NameIndexTask *task = new NameIndexTask(builtIndex, builtFunctions);
+    connect(task, &NameIndexTask::finished, this,
+    [this, generation, builtIndex, builtFunctions]() {
+        if (generation != buildGeneration)
+            return;
+        index = builtIndex;
+        functions = builtFunctions;
+        building = false;
+    });
+    pool.start(task);
+}
 
-    setupCompleter();
+void Omnibar::updateCompletions(const QString &text)
+{
+    QString query = text.trimmed();
+    if (!index || query.isEmpty()) {
+        completionModel->setStringList(QStringList());
+        return;
+    }
+    completionModel->setStringList(index->find(query, COMPLETION_LIMIT));
 }
 
-void Omnibar::restoreCompleter()
+// Changes during a build may be missing from what the task read, so the build starts over
+void Omnibar::addName(const QString &name)
 {
-    QCompleter *completer = this->completer();
-    completer->setFilterMode(Qt::MatchContains);
+    if (building) {
+        rebuildIndex();
+    } else if (index) {
+        index->add(name);
+    }
+}
+
+void Omnibar::removeName(const QString &name)
+{
+    if (building) {
+        rebuildIndex();
+    } else if (index) {
+        index->remove(name);
+    }
+}
+
+void Omnibar::renameName(const QString &oldName, const QString &newName)
+{
+    if (building) {
+        rebuildIndex();
+        return;
+    }
+    if (!index)
+        return;
+
+    index->remove(oldName);
+    index->add(newName);
+    for (auto it = functions->begin(); it != functions->end(); ++it) {
+        if (it.value() == oldName)
+            it.value() = newName;
+    }
+}
+
+void Omnibar::updateFunctions(RVA from, RVA to)
+{
+    if (building) {
+        rebuildIndex();
+        return;
+    }
+    if (!index)
+        return;
+
+    auto it = functions->lowerBound(from);
+    while (it != functions->end() && it.key() <= to) {
+        index->remove(it.value());
+        it = functions->erase(it);
+    }
+    for (const FunctionDescription &function : Core()->getFunctionsInRange(from, to)) {
+        index->add(function.name);
+        functions->insert(function.offset, function.name);
+    }
 }
 
 void Omnibar::clear()
@@ -71,5 +161,4 @@ void Omnibar::on_gotoEntry_returnPressed()
 
     this->setText("");
     this->clearFocus();
-    this->restoreCompleter();
 }
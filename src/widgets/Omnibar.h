@@ -2,30 +2,52 @@
 #define OMNIBAR_H
 
 #include <QLineEdit>
+#include <QThreadPool>
+#include <QMap>
+
+#include <memory>
+
+#include "Cutter.h"
 
 class MainWindow;
+class NameIndex;
+class QStringListModel;
 
 class Omnibar : public QLineEdit
 {
     Q_OBJECT
 public:
     explicit Omnibar(MainWindow *main, QWidget *parent = 0);
-
-    void refresh(const QStringList &flagList);
+    ~Omnibar();
 
 private slots:
     void on_gotoEntry_returnPressed();
 
-    void restoreCompleter();
+    void rebuildIndex();
+    void updateCompletions(const QString &text);
+    void addName(const QString &name);
+    void removeName(const QString &name);
+    void renameName(const QString &oldName, const QString &newName);
+    void updateFunctions(RVA from, RVA to);
 
 public slots:
     void clear();
 
 private:
-    void setupCompleter();
+    // Most completions shown for one text
+    static const int COMPLETION_LIMIT = 50;
 
     MainWindow          *main;
-    QStringList         flags;
+    QStringListModel    *completionModel;
+
+    // Builds the index, one at a time
+    QThreadPool pool;
+    int buildGeneration = 0;
+    bool building = false;
+    // Names of all flags, functions and symbols, null until the first one is built
+    std::shared_ptr<NameIndex> index;
+    // Names of all functions by address, to find those removed from a range
+    std::shared_ptr<QMap<RVA, QString>> functions;
 };
 
 #endif // OMNIBAR_H
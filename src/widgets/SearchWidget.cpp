@@ -8,7 +8,8 @@
 
 SearchModel::SearchModel(QList<SearchDescription> *search, QObject *parent)
     : QAbstractListModel(parent),
-      search(search)
+      search(search),
+      table(NumberCount, StringCount)
 {
 }
 
@@ -78,6 +79,15 @@ void SearchModel::beginReloadSearch()
 
 void SearchModel::endReloadSearch()
 {
+    table.clear();
+    table.reserve(search->count());
+    for (const SearchDescription &exp : *search) {
+        int row = table.appendRow();
+        table.setNumber(OffsetNumber, row, exp.offset);
+        table.setNumber(SizeNumber, row, exp.size);
+        table.setString(CodeString, row, exp.code);
+        table.setString(DataString, row, exp.data);
+    }
     endResetModel();
 }
 
@@ -88,35 +98,34 @@ SearchSortFilterProxyModel::SearchSortFilterProxyModel(SearchModel *source_model
     setSourceModel(source_model);
 }
 
-bool SearchSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
+bool SearchSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &) const
 {
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    SearchDescription search = index.data(
-                                   SearchModel::SearchDescriptionRole).value<SearchDescription>();
-    return search.code.contains(filterRegExp());
+    const ColumnarTable &table = static_cast<SearchModel *>(sourceModel())->getTable();
+    if (row >= table.rowCount())
+        return false;
+    return table.matches(SearchModel::CodeString, row, filterRegExp());
 }
 
 bool SearchSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
-    SearchDescription left_search = left.data(
-                                        SearchModel::SearchDescriptionRole).value<SearchDescription>();
-    SearchDescription right_search = right.data(
-                                         SearchModel::SearchDescriptionRole).value<SearchDescription>();
+    const ColumnarTable &table = static_cast<SearchModel *>(sourceModel())->getTable();
+    int l = left.row();
+    int r = right.row();
 
     switch (left.column()) {
     case SearchModel::SIZE:
-        return left_search.size < right_search.size;
+        return table.numberLessThan(SearchModel::SizeNumber, l, r);
     case SearchModel::OFFSET:
-        return left_search.offset < right_search.offset;
+        return table.numberLessThan(SearchModel::OffsetNumber, l, r);
     case SearchModel::CODE:
-        return left_search.code < right_search.code;
+        return table.stringLessThan(SearchModel::CodeString, l, r);
     case SearchModel::DATA:
-        return left_search.data < right_search.data;
+        return table.stringLessThan(SearchModel::DataString, l, r);
     default:
         break;
     }
 
-    return left_search.offset < right_search.offset;
+    return table.numberLessThan(SearchModel::OffsetNumber, l, r);
 }
 
 
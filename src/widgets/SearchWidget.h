@@ -8,6 +8,7 @@
 
 #include "Cutter.h"
 #include "CutterDockWidget.h"
+#include "utils/ColumnarTable.h"
 
 class MainWindow;
 class QTreeWidgetItem;
@@ -19,9 +20,13 @@ class SearchModel: public QAbstractListModel
 
 private:
     QList<SearchDescription> *search;
+    // Same rows as search, for the proxy
+    ColumnarTable table;
 
 public:
     enum Columns { OFFSET = 0, SIZE, CODE, DATA, COUNT };
+    enum TableNumber { OffsetNumber = 0, SizeNumber, NumberCount };
+    enum TableString { CodeString = 0, DataString, StringCount };
     static const int SearchDescriptionRole = Qt::UserRole;
 
     SearchModel(QList<SearchDescription> *search, QObject *parent = 0);
@@ -34,6 +39,11 @@ public:
 
     void beginReloadSearch();
     void endReloadSearch();
+
+    const ColumnarTable &getTable() const
+    {
+        return table;
+    }
 };
 
 
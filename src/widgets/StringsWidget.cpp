@@ -10,7 +10,8 @@
 
 StringsModel::StringsModel(QList<StringDescription> *strings, QObject *parent)
     : QAbstractListModel(parent),
-      strings(strings)
+      strings(strings),
+      table(NumberCount, StringCount)
 {
 }
 
@@ -44,6 +45,8 @@ QVariant StringsModel::data(const QModelIndex &index, int role) const
             return str.length;
         case SIZE:
             return str.size;
+        case SECTION:
+            return str.section;
         default:
             return QVariant();
         }
@@ -69,6 +72,8 @@ QVariant StringsModel::headerData(int section, Qt::Orientation, int role) const
             return tr("Length");
         case SIZE:
             return tr("Size");
+        case SECTION:
+            return tr("Section");
         default:
             return QVariant();
         }
@@ -84,49 +89,93 @@ void StringsModel::beginReload()
 
 void StringsModel::endReload()
 {
+    table.clear();
+    table.reserve(strings->count());
+    for (const StringDescription &str : *strings) {
+        appendToTable(str);
+    }
     endResetModel();
 }
 
+void StringsModel::appendStrings(const QList<StringDescription> &newStrings)
+{
+    if (newStrings.isEmpty())
+        return;
+
+    int first = strings->count();
+    beginInsertRows(QModelIndex(), first, first + newStrings.count() - 1);
+    strings->append(newStrings);
+    for (const StringDescription &str : newStrings) {
+        appendToTable(str);
+    }
+    endInsertRows();
+}
+
+void StringsModel::appendToTable(const StringDescription &str)
+{
+    int row = table.appendRow();
+    table.setNumber(OffsetNumber, row, str.vaddr);
+    table.setNumber(LengthNumber, row, str.length);
+    table.setNumber(SizeNumber, row, str.size);
+    table.setString(StringString, row, str.string);
+    table.setString(TypeString, row, str.type);
+    table.setString(SectionString, row, str.section);
+}
+
 StringsSortFilterProxyModel::StringsSortFilterProxyModel(StringsModel *source_model,
                                                          QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : QSortFilterProxyModel(parent),
+      filterEngine(new FilterEngine(this))
 {
+    filterEngine->setCaseSensitivity(Qt::CaseInsensitive);
+    filterEngine->setSource(source_model->getTable(), StringsModel::StringString);
+
+    // Connected before setSourceModel(), so the engine has the new rows before the proxy maps them
+    auto updateSource = [this, source_model]() {
+        filterEngine->setSource(source_model->getTable(), StringsModel::StringString);
+    };
+    connect(source_model, &QAbstractItemModel::modelReset, this, updateSource);
+    // Batches of the scanner only add rows, only their new strings have to be matched
+    connect(source_model, &QAbstractItemModel::rowsInserted, filterEngine,
+            &FilterEngine::appendRows);
+    connect(filterEngine, &FilterEngine::resultsReady, this, [this]() {
+        invalidateFilter();
+    });
+
     setSourceModel(source_model);
-    setFilterCaseSensitivity(Qt::CaseInsensitive);
     setSortCaseSensitivity(Qt::CaseInsensitive);
 }
 
-bool StringsSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &parent) const
+bool StringsSortFilterProxyModel::filterAcceptsRow(int row, const QModelIndex &) const
 {
-    QModelIndex index = sourceModel()->index(row, 0, parent);
-    StringDescription str = index.data(StringsModel::StringDescriptionRole).value<StringDescription>();
-    return str.string.contains(filterRegExp());
+    return filterEngine->accepts(row);
 }
 
 bool StringsSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
-    StringDescription left_str = left.data(
-                                     StringsModel::StringDescriptionRole).value<StringDescription>();
-    StringDescription right_str = right.data(
-                                      StringsModel::StringDescriptionRole).value<StringDescription>();
+    const ColumnarTable &table = static_cast<StringsModel *>(sourceModel())->getTable();
+    int l = left.row();
+    int r = right.row();
 
     switch (left.column()) {
     case StringsModel::OFFSET:
-        return left_str.vaddr < right_str.vaddr;
+        return table.numberLessThan(StringsModel::OffsetNumber, l, r);
     case StringsModel::STRING: // sort by string
-        return left_str.string < right_str.string;
+        return table.stringLessThan(StringsModel::StringString, l, r);
     case StringsModel::TYPE: // sort by type
-        return left_str.type < right_str.type;
+        return table.stringLessThan(StringsModel::TypeString, l, r);
     case StringsModel::SIZE: // sort by size
-        return left_str.size < right_str.size;
+        return table.numberLessThan(StringsModel::SizeNumber, l, r);
     case StringsModel::LENGTH: // sort by length
-        return left_str.length < right_str.length;
+        return table.numberLessThan(StringsModel::LengthNumber, l, r);
+    case StringsModel::SECTION: // sort by section
+        return table.stringLessThan(StringsModel::SectionString, l, r);
     default:
         break;
     }
 
     // fallback
-    return left_str.vaddr < right_str.vaddr;
+    return table.numberLessThan(StringsModel::OffsetNumber, l, r);
 }
 
 
@@ -153,8 +202,8 @@ StringsWidget::StringsWidget(MainWindow *main, QAction *action) :
     ui->stringsTreeView->setModel(proxy_model);
     ui->stringsTreeView->sortByColumn(StringsModel::OFFSET, Qt::AscendingOrder);
 
-    connect(ui->quickFilterView, SIGNAL(filterTextChanged(const QString &)), proxy_model,
-            SLOT(setFilterWildcard(const QString &)));
+    connect(ui->quickFilterView, &QuickFilterView::filterTextChanged,
+            proxy_model->getFilterEngine(), &FilterEngine::setQuery);
     connect(ui->quickFilterView, SIGNAL(filterClosed()), ui->stringsTreeView, SLOT(setFocus()));
 
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(refreshStrings()));
@@ -170,15 +219,32 @@ void StringsWidget::on_stringsTreeView_doubleClicked(const QModelIndex &index)
 
 void StringsWidget::refreshStrings()
 {
+    // Deleting the scanner waits for its tasks, so no batch of the old scan arrives anymore
+    delete scanner;
+
     model->beginReload();
-    strings = CutterCore::getInstance()->getAllStrings();
+    strings.clear();
     model->endReload();
+    columnsSized = false;
+
+    // Rows are added as the scanner finds them, the view stays usable meanwhile
+    scanner = new StringScanner(this);
+    connect(scanner, &StringScanner::stringsFound, this,
+    [this](const QList<StringDescription> &found) {
+        model->appendStrings(found);
+        if (!columnsSized) {
+            resizeColumns();
+            columnsSized = true;
+        }
+    });
+    connect(scanner, &StringScanner::finished, this, &StringsWidget::resizeColumns);
+    scanner->start(StringScanner::defaultSections(), StringScanner::defaultMinLength());
+}
 
-    ui->stringsTreeView->resizeColumnToContents(0);
-    ui->stringsTreeView->resizeColumnToContents(1);
-    if (ui->stringsTreeView->columnWidth(1) > 300)
-        ui->stringsTreeView->setColumnWidth(1, 300);
-    ui->stringsTreeView->resizeColumnToContents(2);
-    ui->stringsTreeView->resizeColumnToContents(3);
-    ui->stringsTreeView->resizeColumnToContents(4);
+void StringsWidget::resizeColumns()
+{
+    qhelpers::adjustColumnsFromSample(ui->stringsTreeView, StringsModel::COUNT,
+                                      COLUMN_SAMPLE_ROWS);
+    if (ui->stringsTreeView->columnWidth(StringsModel::STRING) > 300)
+        ui->stringsTreeView->setColumnWidth(StringsModel::STRING, 300);
 }
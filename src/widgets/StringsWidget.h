@@ -5,6 +5,9 @@
 
 #include "Cutter.h"
 #include "CutterDockWidget.h"
+#include "utils/ColumnarTable.h"
+#include "utils/FilterEngine.h"
+#include "utils/StringScanner.h"
 
 #include <QAbstractListModel>
 #include <QSortFilterProxyModel>
@@ -22,9 +25,15 @@ class StringsModel: public QAbstractListModel
 
 private:
     QList<StringDescription> *strings;
+    // Same rows as strings, for the proxy
+    ColumnarTable table;
+
+    void appendToTable(const StringDescription &str);
 
 public:
-    enum Columns { OFFSET = 0, STRING, TYPE, LENGTH, SIZE, COUNT };
+    enum Columns { OFFSET = 0, STRING, TYPE, LENGTH, SIZE, SECTION, COUNT };
+    enum TableNumber { OffsetNumber = 0, LengthNumber, SizeNumber, NumberCount };
+    enum TableString { StringString = 0, TypeString, SectionString, StringCount };
     static const int StringDescriptionRole = Qt::UserRole;
 
     StringsModel(QList<StringDescription> *strings, QObject *parent = 0);
@@ -37,6 +46,14 @@ public:
 
     void beginReload();
     void endReload();
+
+    // Adds rows at the end, without resetting the model
+    void appendStrings(const QList<StringDescription> &newStrings);
+
+    const ColumnarTable &getTable() const
+    {
+        return table;
+    }
 };
 
 
@@ -48,9 +65,18 @@ class StringsSortFilterProxyModel : public QSortFilterProxyModel
 public:
     StringsSortFilterProxyModel(StringsModel *source_model, QObject *parent = 0);
 
+    // Filters by string, replaces setFilterWildcard()
+    FilterEngine *getFilterEngine() const
+    {
+        return filterEngine;
+    }
+
 protected:
     bool filterAcceptsRow(int row, const QModelIndex &parent) const override;
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private:
+    FilterEngine *filterEngine;
 };
 
 
@@ -73,6 +99,15 @@ private:
     StringsModel *model;
     StringsSortFilterProxyModel *proxy_model;
     QList<StringDescription> strings;
+
+    // Rows measured for the column widths
+    static const int COLUMN_SAMPLE_ROWS = 200;
+
+    // Scans the sections of the current refresh, replaced by the next one
+    StringScanner *scanner = nullptr;
+    bool columnsSized = false;
+
+    void resizeColumns();
 };
 
 #endif // STRINGSWIDGET_H
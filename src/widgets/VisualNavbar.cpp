@@ -2,12 +2,16 @@
 
 #include "MainWindow.h"
 #include "utils/TempConfig.h"
+#include "utils/StringScanner.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <QGraphicsView>
 #include <QComboBox>
 #include <QGraphicsScene>
 #include <QGraphicsRectItem>
+#include <QGraphicsPixmapItem>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -17,6 +21,7 @@
 VisualNavbar::VisualNavbar(MainWindow *main, QWidget *parent) :
     QToolBar(main),
     graphicsView(new QGraphicsView),
+    dataGraphicsItem(nullptr),
     cursorGraphicsItem(nullptr),
     main(main)
 {
@@ -41,8 +46,8 @@ VisualNavbar::VisualNavbar(MainWindow *main, QWidget *parent) :
 
     connect(Core(), SIGNAL(seekChanged(RVA)), this, SLOT(on_seekChanged(RVA)));
     connect(Core(), SIGNAL(refreshAll()), this, SLOT(fetchAndPaintData()));
-    connect(Core(), SIGNAL(functionsChanged()), this, SLOT(updateMetadataAndPaint()));
-    connect(Core(), SIGNAL(flagsChanged()), this, SLOT(updateMetadataAndPaint()));
+    connect(Core(), SIGNAL(functionsChangedInRange(RVA, RVA)),
+            this, SLOT(updateFunctionsAndPaint(RVA, RVA)));
 
     graphicsScene = new QGraphicsScene(this);
 
@@ -88,75 +93,52 @@ bool VisualNavbar::sortSectionLessThan(const SectionDescription &section1,
     return section1.vaddr < section2.vaddr;
 }
 
-VisualNavbar::MappedSegment *VisualNavbar::mappedSegmentForAddress(RVA addr)
+int VisualNavbar::mappedSegmentIndexForAddress(RVA addr) const
 {
-    for (int i = 0; i < mappedSegments.length(); i++) {
-        MappedSegment *mappedSegment = &mappedSegments[i];
-        if ((mappedSegment->address_from <= addr) && (addr <= mappedSegment->address_to)) {
-            return mappedSegment;
-        }
+    // Last segment starting at or before addr, overlapping maps resolve to the later one
+    auto it = std::upper_bound(mappedSegments.begin(), mappedSegments.end(), addr,
+    [](RVA value, const MappedSegment & segment) {
+        return value < segment.address_from;
+    });
+    if (it == mappedSegments.begin()) {
+        return -1;
+    }
+    --it;
+    if (addr > it->address_to) {
+        return -1;
     }
-    return nullptr;
+    return int(it - mappedSegments.begin());
+}
+
+VisualNavbar::MappedSegment *VisualNavbar::mappedSegmentForAddress(RVA addr)
+{
+    int index = mappedSegmentIndexForAddress(addr);
+    return index < 0 ? nullptr : &mappedSegments[index];
 }
 
 void VisualNavbar::fetchData()
 {
-    // TODO: This code is quite verbose but very readable. The goal is to
-    //       experiment until we know what we want and then start to optimize.
     sections = Core()->getAllSections();
 
     // Sort sections so we don't have to filter for overlaps afterwards
     qSort(sections.begin(), sections.end(), sortSectionLessThan);
 
+    // Sorted by start, a section can only overlap the segment built last
     mappedSegments.clear();
-    for (SectionDescription section : sections) {
-        bool segment_found = false;
-        for (int i = 0; i < mappedSegments.count(); i++) {
-            MappedSegment &mappedSegment = mappedSegments[i];
-            // Check if the segment contains the section
-            bool segment_contains_section_start = false;
-            if ((mappedSegment.address_from <= section.vaddr) &&
-                    (section.vaddr <= mappedSegment.address_to)) {
-                segment_contains_section_start = true;
-            }
-            bool segment_contains_section_end = false;
-            if ((mappedSegment.address_from <= section.vaddr + section.vsize) &&
-                    (section.vaddr + section.vsize <= mappedSegment.address_to)) {
-                segment_contains_section_end = true;
-            }
-
-            // Check if the section contains the segment
-            bool section_contains_segment_start = false;
-            bool section_contains_segment_end = false;
-            if ((section.vaddr <= mappedSegment.address_from) &&
-                    (mappedSegment.address_from <= section.vaddr + section.vsize)) {
-                section_contains_segment_start = true;
-            }
-            if ((section.vaddr <= mappedSegment.address_to) &&
-                    (mappedSegment.address_to <= section.vaddr + section.vsize)) {
-                section_contains_segment_end = true;
-            }
-
-            if (segment_contains_section_start | segment_contains_section_end |
-                    section_contains_segment_start | section_contains_segment_end) {
-                if (section.vaddr < mappedSegment.address_from) {
-                    mappedSegment.address_from = section.vaddr;
-                }
-                if (mappedSegment.address_to < section.vaddr + section.vsize) {
-                    mappedSegment.address_to = section.vaddr + section.vsize;
-                }
-                segment_found = true;
-                mappedSegment.sectionDescriptions.append(section);
-                break;
+    for (const SectionDescription &section : sections) {
+        if (!mappedSegments.isEmpty() && section.vaddr <= mappedSegments.last().address_to) {
+            MappedSegment &mappedSegment = mappedSegments.last();
+            if (mappedSegment.address_to < section.vaddr + section.vsize) {
+                mappedSegment.address_to = section.vaddr + section.vsize;
             }
-        }
-        if (!segment_found) {
-            MappedSegment mappedSegment;
-            mappedSegment.address_from = section.vaddr;
-            mappedSegment.address_to = section.vaddr + section.vsize;
             mappedSegment.sectionDescriptions.append(section);
-            mappedSegments.append(mappedSegment);
+            continue;
         }
+        MappedSegment mappedSegment;
+        mappedSegment.address_from = section.vaddr;
+        mappedSegment.address_to = section.vaddr + section.vsize;
+        mappedSegment.sectionDescriptions.append(section);
+        mappedSegments.append(mappedSegment);
     }
 
     // If the file does not contain any sections we get the segments
@@ -172,6 +154,10 @@ void VisualNavbar::fetchData()
             mappedSegment.address_to = map["to"].toVariant().toULongLong();
             mappedSegments.append(mappedSegment);
         }
+        std::sort(mappedSegments.begin(), mappedSegments.end(),
+        [](const MappedSegment & a, const MappedSegment & b) {
+            return a.address_from < b.address_from;
+        });
     }
 
     totalMappedSize = 0;
@@ -182,19 +168,75 @@ void VisualNavbar::fetchData()
     updateMetadata();
 }
 
-void VisualNavbar::updateMetadataAndPaint()
+// Only the functions starting in [from, to] are fetched again and their
+// coverage is moved in the buckets, the rest of the bar stays as it is
+void VisualNavbar::updateFunctionsAndPaint(RVA from, RVA to)
 {
-    qWarning() << "Update metadata & paint";
-    updateMetadata();
-    fillData();
+    auto metadataLessThan = [](const MappedSegmentMetadata & metadata, RVA address) {
+        return metadata.address < address;
+    };
+    bool bucketed = !codeBuckets.empty();
+
+    // A function containing from may be the one which changed, take it along
+    int segmentIndex = mappedSegmentIndexForAddress(from);
+    if (segmentIndex >= 0) {
+        const auto &functions = mappedSegments[segmentIndex].functions;
+        auto it = std::lower_bound(functions.begin(), functions.end(), from, metadataLessThan);
+        if (it != functions.begin()) {
+            --it;
+            if (from < it->address + it->size) {
+                from = it->address;
+            }
+        }
+    }
+
+    for (int i = 0; i < mappedSegments.length(); i++) {
+        MappedSegment &mappedSegment = mappedSegments[i];
+        if (mappedSegment.address_to < from || to < mappedSegment.address_from) {
+            continue;
+        }
+        auto &functions = mappedSegment.functions;
+        auto first = std::lower_bound(functions.begin(), functions.end(), from, metadataLessThan);
+        auto last = first;
+        while (last != functions.end() && last->address <= to) {
+            if (bucketed) {
+                addToBuckets(codeBuckets, i, *last, -1.0f);
+            }
+            ++last;
+        }
+        functions.erase(first, last);
+    }
+
+    for (const FunctionDescription &function : Core()->getFunctionsInRange(from, to)) {
+        int index = mappedSegmentIndexForAddress(function.offset);
+        if (index < 0) {
+            continue;
+        }
+        MappedSegmentMetadata metadata;
+        metadata.address = function.offset;
+        metadata.size = function.size;
+        auto &functions = mappedSegments[index].functions;
+        functions.insert(std::lower_bound(functions.begin(), functions.end(), metadata.address,
+                                          metadataLessThan), metadata);
+        if (bucketed) {
+            addToBuckets(codeBuckets, index, metadata, 1.0f);
+        }
+    }
+
+    paintBuckets();
 }
 
 void VisualNavbar::updateMetadata()
+{
+    updateFunctions();
+    updateSymbols();
+    updateStrings();
+}
+
+void VisualNavbar::updateFunctions()
 {
     for (int i = 0; i < mappedSegments.length(); i++) {
         mappedSegments[i].functions.clear();
-        mappedSegments[i].symbols.clear();
-        mappedSegments[i].strings.clear();
     }
 
     QList<FunctionDescription> functions = Core()->getAllFunctions();
@@ -208,6 +250,22 @@ void VisualNavbar::updateMetadata()
         }
     }
 
+    // Kept sorted for updating ranges of them
+    for (int i = 0; i < mappedSegments.length(); i++) {
+        auto &functions = mappedSegments[i].functions;
+        std::sort(functions.begin(), functions.end(),
+        [](const MappedSegmentMetadata & a, const MappedSegmentMetadata & b) {
+            return a.address < b.address;
+        });
+    }
+}
+
+void VisualNavbar::updateSymbols()
+{
+    for (int i = 0; i < mappedSegments.length(); i++) {
+        mappedSegments[i].symbols.clear();
+    }
+
     QList<SymbolDescription> symbols = Core()->getAllSymbols();
     for (auto symbol : symbols) {
         auto mappedSegment = mappedSegmentForAddress(symbol.vaddr);
@@ -218,39 +276,158 @@ void VisualNavbar::updateMetadata()
             mappedSegment->symbols.append(metadata);
         }
     }
+}
 
-    QList<StringDescription> strings = Core()->getAllStrings();
-    for (auto string : strings) {
-        MappedSegment *mappedSegment = mappedSegmentForAddress(string.vaddr);
-        if (mappedSegment) {
-            MappedSegmentMetadata metadata;
-            metadata.address = string.vaddr;
-            metadata.size = string.string.length();
-            mappedSegment->strings.append(metadata);
+void VisualNavbar::updateStrings()
+{
+    // Deleting the scanner waits for its tasks, so no batch of the old scan arrives anymore
+    delete stringScanner;
+    for (int i = 0; i < mappedSegments.length(); i++) {
+        mappedSegments[i].strings.clear();
+    }
+
+    // The segments already cover all sections, or the maps if there are none
+    QList<SectionDescription> ranges;
+    for (const MappedSegment &mappedSegment : mappedSegments) {
+        SectionDescription range;
+        range.vaddr = mappedSegment.address_from;
+        range.paddr = 0;
+        range.size = mappedSegment.address_to - mappedSegment.address_from;
+        range.vsize = range.size;
+        ranges.append(range);
+    }
+
+    stringScanner = new StringScanner(this);
+    connect(stringScanner, &StringScanner::stringsFound, this, &VisualNavbar::addStringsAndPaint);
+    stringScanner->start(ranges, StringScanner::defaultMinLength());
+}
+
+void VisualNavbar::addStringsAndPaint(const QList<StringDescription> &strings)
+{
+    bool bucketed = !stringBuckets.empty();
+    for (const StringDescription &string : strings) {
+        int index = mappedSegmentIndexForAddress(string.vaddr);
+        if (index < 0) {
+            continue;
+        }
+        MappedSegmentMetadata metadata;
+        metadata.address = string.vaddr;
+        metadata.size = string.size;
+        mappedSegments[index].strings.append(metadata);
+        if (bucketed) {
+            addToBuckets(stringBuckets, index, metadata, 1.0f);
+        }
+    }
+
+    if (bucketed) {
+        paintBuckets();
+    }
+}
+
+// Adds up which share of each pixel column is covered by the given metadata,
+// like an antialiased rectangle per entry would
+void VisualNavbar::fillBuckets(std::vector<float> &buckets,
+                               QList<MappedSegmentMetadata> MappedSegment::*metadata)
+{
+    int w = int(xToAddress.isEmpty() ? 0 : std::ceil(xToAddress.last().x_end));
+    buckets.assign(w, 0.0f);
+    if (w == 0) {
+        return;
+    }
+
+    for (int i = 0; i < mappedSegments.length() && i < xToAddress.length(); i++) {
+        for (const MappedSegmentMetadata &s : mappedSegments[i].*metadata) {
+            addToBuckets(buckets, i, s, 1.0f);
         }
     }
 }
 
-void VisualNavbar::drawMetadata(QList<MappedSegmentMetadata> metadata,
-                                RVA offset,
-                                double x,
-                                double width_per_byte,
-                                double h, QColor color)
+// sign is -1 to take an entry out of the buckets again
+void VisualNavbar::addToBuckets(std::vector<float> &buckets, int segmentIndex,
+                                const MappedSegmentMetadata &metadata, float sign)
+{
+    int w = int(buckets.size());
+    if (segmentIndex >= xToAddress.length()) {
+        return;
+    }
+    double width_per_byte = (double)this->graphicsView->width() / (double)totalMappedSize;
+    const MappedSegment &mappedSegment = mappedSegments[segmentIndex];
+    double start = xToAddress[segmentIndex].x_start
+                   + ((double)(metadata.address - mappedSegment.address_from) * width_per_byte);
+    double end = start + (double)metadata.size * width_per_byte;
+    int first = qMax(0, int(start));
+    int last = qMin(w - 1, int(std::ceil(end)) - 1);
+    for (int p = first; p <= last; p++) {
+        buckets[p] += sign * float(qMin(end, p + 1.0) - qMax(start, double(p)));
+    }
+}
+
+static QRgb blend(QRgb background, const QColor &color, float alpha)
+{
+    alpha = qMin(alpha, 1.0f);
+    return qRgb(int(qRed(background) + (color.red() - qRed(background)) * alpha),
+                int(qGreen(background) + (color.green() - qGreen(background)) * alpha),
+                int(qBlue(background) + (color.blue() - qBlue(background)) * alpha));
+}
+
+// Strings are drawn first, then symbols and functions on top, as separate items used to be
+void VisualNavbar::paintBuckets()
 {
-    for (auto s : metadata) {
-        double block_x = x + ((double)(s.address - offset) * width_per_byte);
-        double block_width = (double)s.size * width_per_byte;
-        QGraphicsRectItem *rect = new QGraphicsRectItem(block_x, 0, block_width, h);
-        rect->setPen(Qt::NoPen);
-        rect->setBrush(QBrush(color));
-        graphicsScene->addItem(rect);
+    if (!dataGraphicsItem) {
+        return;
+    }
+    int w = int(codeBuckets.size());
+    int h = this->graphicsView->height();
+    if (w == 0 || h <= 0) {
+        dataGraphicsItem->setPixmap(QPixmap());
+        return;
+    }
+
+    QColor emptyColor = Config()->getColor("gui.navbar.empty");
+    QColor stringColor = Config()->getColor("gui.navbar.str");
+    QColor symbolColor = Config()->getColor("gui.navbar.sym");
+    QColor codeColor = Config()->getColor("gui.navbar.code");
+    QRgb background = graphicsScene->backgroundBrush().color().rgb();
+
+    if (dataImage.size() != QSize(w, h)) {
+        dataImage = QImage(w, h, QImage::Format_RGB32);
+    }
+    QRgb *line = reinterpret_cast<QRgb *>(dataImage.scanLine(0));
+    std::fill(line, line + w, background);
+    for (int i = 0; i < xToAddress.length(); i++) {
+        int first = qMax(0, int(xToAddress[i].x_start));
+        int last = qMin(w, int(std::ceil(xToAddress[i].x_end)));
+        for (int p = first; p < last; p++) {
+            line[p] = emptyColor.rgb();
+        }
+    }
+    for (int p = 0; p < w; p++) {
+        if (stringBuckets[p] > 0) {
+            line[p] = blend(line[p], stringColor, stringBuckets[p]);
+        }
+        if (symbolBuckets[p] > 0) {
+            line[p] = blend(line[p], symbolColor, symbolBuckets[p]);
+        }
+        if (codeBuckets[p] > 0) {
+            line[p] = blend(line[p], codeColor, codeBuckets[p]);
+        }
     }
+    // Every row looks the same
+    for (int y = 1; y < h; y++) {
+        memcpy(dataImage.scanLine(y), line, w * sizeof(QRgb));
+    }
+    dataGraphicsItem->setPixmap(QPixmap::fromImage(dataImage));
 }
 
 void VisualNavbar::fillData()
 {
     graphicsScene->clear();
+    dataGraphicsItem = nullptr;
     cursorGraphicsItem = nullptr;
+    xToAddress.clear();
+    stringBuckets.clear();
+    symbolBuckets.clear();
+    codeBuckets.clear();
     // Do not try to draw if no sections are available.
     if (mappedSegments.length() == 0) {
         return;
@@ -260,29 +437,10 @@ void VisualNavbar::fillData()
     int h = this->graphicsView->height();
 
     double width_per_byte = (double)w / (double)totalMappedSize;
-    xToAddress.clear();
     double current_x = 0;
     for (auto mappedSegment : mappedSegments) {
         RVA segment_size = mappedSegment.address_to - mappedSegment.address_from;
         double segment_width = (double)segment_size * width_per_byte;
-        QGraphicsRectItem *rect = new QGraphicsRectItem(current_x, 0, segment_width, h);
-        rect->setBrush(QBrush(Config()->getColor("gui.navbar.empty")));
-        graphicsScene->addItem(rect);
-        drawMetadata(mappedSegment.strings,
-                     mappedSegment.address_from,
-                     current_x,
-                     width_per_byte,
-                     h, Config()->getColor("gui.navbar.str"));
-        drawMetadata(mappedSegment.symbols,
-                     mappedSegment.address_from,
-                     current_x,
-                     width_per_byte,
-                     h, Config()->getColor("gui.navbar.sym"));
-        drawMetadata(mappedSegment.functions,
-                     mappedSegment.address_from,
-                     current_x,
-                     width_per_byte,
-                     h, Config()->getColor("gui.navbar.code"));
 
         // Keep track of where which memory segment is mapped so we are able to convert from
         // address to X coordinate and vice versa.
@@ -296,8 +454,14 @@ void VisualNavbar::fillData()
         current_x += segment_width;
     }
 
+    fillBuckets(stringBuckets, &MappedSegment::strings);
+    fillBuckets(symbolBuckets, &MappedSegment::symbols);
+    fillBuckets(codeBuckets, &MappedSegment::functions);
+    dataGraphicsItem = graphicsScene->addPixmap(QPixmap());
+    paintBuckets();
+
     // Update scene width
-    graphicsScene->setSceneRect(graphicsScene->itemsBoundingRect());
+    graphicsScene->setSceneRect(0, 0, current_x, h);
 
     // Draw cursor
     drawCursor();
@@ -350,36 +514,50 @@ void VisualNavbar::mouseMoveEvent(QMouseEvent *event)
 
 RVA VisualNavbar::localXToAddress(double x)
 {
-    for (auto x2a : xToAddress) {
-        if ((x2a.x_start <= x) && (x <= x2a.x_end)) {
-            double offset = (x - x2a.x_start) / (x2a.x_end - x2a.x_start);
-            double size = x2a.address_to - x2a.address_from;
-            return x2a.address_from + (offset * size);
-        }
+    auto it = std::upper_bound(xToAddress.begin(), xToAddress.end(), x,
+    [](double value, const struct xToAddress & x2a) {
+        return value < x2a.x_start;
+    });
+    if (it == xToAddress.begin()) {
+        return RVA_INVALID;
     }
-    return RVA_INVALID;
+    --it;
+    if (x > it->x_end) {
+        return RVA_INVALID;
+    }
+    double offset = (x - it->x_start) / (it->x_end - it->x_start);
+    double size = it->address_to - it->address_from;
+    return it->address_from + (offset * size);
 }
 
 double VisualNavbar::addressToLocalX(RVA address)
 {
-    for (auto x2a : xToAddress) {
-        if ((x2a.address_from <= address) && (address < x2a.address_to)) {
-            double offset = (double)(address - x2a.address_from) / (double)(x2a.address_to - x2a.address_from);
-            double size = x2a.x_end - x2a.x_start;
-            return x2a.x_start + (offset * size);
-        }
+    auto it = std::upper_bound(xToAddress.begin(), xToAddress.end(), address,
+    [](RVA value, const struct xToAddress & x2a) {
+        return value < x2a.address_from;
+    });
+    if (it == xToAddress.begin()) {
+        return nan("");
+    }
+    --it;
+    if (address >= it->address_to) {
+        return nan("");
     }
-    return nan("");
+    double offset = (double)(address - it->address_from) / (double)(it->address_to - it->address_from);
+    double size = it->x_end - it->x_start;
+    return it->x_start + (offset * size);
 }
 
 QList<QString> VisualNavbar::sectionsForAddress(RVA address)
 {
     QList<QString> ret;
-    for (auto mappedSegment : mappedSegments) {
-        for (auto section : mappedSegment.sectionDescriptions) {
-            if ((section.vaddr <= address) && (address <= section.vaddr + section.vsize)) {
-                ret.append(section.name);
-            }
+    MappedSegment *mappedSegment = mappedSegmentForAddress(address);
+    if (!mappedSegment) {
+        return ret;
+    }
+    for (const auto &section : mappedSegment->sectionDescriptions) {
+        if ((section.vaddr <= address) && (address <= section.vaddr + section.vsize)) {
+            ret.append(section.name);
         }
     }
     return ret;
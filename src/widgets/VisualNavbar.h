@@ -3,11 +3,16 @@
 
 #include <QToolBar>
 #include <QGraphicsScene>
+#include <QImage>
+
+#include <vector>
 
 #include "Cutter.h"
 
 class MainWindow;
+class StringScanner;
 class QGraphicsView;
+class QGraphicsPixmapItem;
 
 class VisualNavbar : public QToolBar
 {
@@ -43,7 +48,8 @@ public slots:
 private slots:
     void fetchAndPaintData();
     void fetchData();
-    void updateMetadataAndPaint();
+    void updateFunctionsAndPaint(RVA from, RVA to);
+    void addStringsAndPaint(const QList<StringDescription> &strings);
     void updateMetadata();
     void fillData();
     void drawCursor();
@@ -52,6 +58,7 @@ private slots:
 private:
     QGraphicsView     *graphicsView;
     QGraphicsScene    *graphicsScene;
+    QGraphicsPixmapItem *dataGraphicsItem;
     QGraphicsRectItem *cursorGraphicsItem;
     MainWindow        *main;
     RVA totalMappedSize;
@@ -59,15 +66,29 @@ private:
     QList<struct xToAddress> xToAddress;
 
     QList<MappedSegment> mappedSegments;
-
-    // Used to check whether the width changed. If yes we need to re-initialize the scene (slow)
-    int previousWidth;
-    void drawMetadata(QList<MappedSegmentMetadata> metadata,
-                      RVA offset,
-                      double x,
-                      double width_per_byte,
-                      double h, QColor color);
-
+    // Strings arrive from it in batches after the rest of the data is fetched
+    StringScanner *stringScanner = nullptr;
+
+    // Share of each pixel column covered by strings, symbols and functions.
+    // Everything is painted into one image from these, instead of one scene item per entry.
+    std::vector<float> stringBuckets;
+    std::vector<float> symbolBuckets;
+    std::vector<float> codeBuckets;
+    QImage dataImage;
+
+    // Used to check whether the width changed. If yes the buckets are filled again
+    int previousWidth = 0;
+    void updateFunctions();
+    void updateSymbols();
+    void updateStrings();
+    void fillBuckets(std::vector<float> &buckets,
+                     QList<MappedSegmentMetadata> MappedSegment::*metadata);
+    void addToBuckets(std::vector<float> &buckets, int segmentIndex,
+                      const MappedSegmentMetadata &metadata, float sign);
+    void paintBuckets();
+
+    // Segments are sorted by address, so these are binary searches
+    int mappedSegmentIndexForAddress(RVA addr) const;
     struct MappedSegment *mappedSegmentForAddress(RVA addr);
     RVA localXToAddress(double x);
     double addressToLocalX(RVA address);